@@ -31,67 +31,158 @@
  */
 
 #include "config.h"
+#include "uart.h"
 #include "pump.h"
 #include "bluetooth.h"
+#include "scheduler.h"
+#include "controltick.h"
+#include "power.h"
+#include "button.h"
+#include "leds.h"
+#include "perf.h"
+#include "watchdog.h"
+#include "adcengine.h"
+#include "calibration.h"
+#include "sensors.h"
+#include "estimator.h"
+#include "samplerate.h"
+#include "supply.h"
+#include "thermostat.h"
+#include "autotune.h"
+#include "feedforward.h"
+#include "eco.h"
+#include "energy.h"
 
 // ============================================================================
 // GLOBAL STATE VARIABLES
 // ============================================================================
 
-// Button state tracking for debouncing
-static unsigned long lastButtonPress = 0;
-static bool lastButtonState = HIGH;
-
-// Timing variables for non-blocking operation
-static unsigned long lastStatusUpdate = 0;
-static unsigned long lastTempRead = 0;
-static unsigned long lastSpeedRead = 0;
-
 // Speed control tracking
 static uint8_t lastPotSpeed = 180;  // Track last potentiometer speed reading
 
+// Button held down since a press that has not switched the mode yet
+static bool buttonHeld = false;
+static unsigned long buttonPressUs = 0;
+
+// Blink code shown while the pump is in PUMP_ERROR (set by whoever caused it)
+static LedPattern errorPattern = LED_PATTERN_ERROR;
+
+// ============================================================================
+// TASK TABLE
+// ============================================================================
+
+// Task bodies (defined below loop())
+void taskButtons();
+void taskCommands();
+void taskSafety();
+void taskTemperature();
+void taskSpeedPot();
+void taskStatus();
+void taskLEDs();
+
+// Task indices (must match the order of the table below)
+enum TaskId {
+  TASK_BUTTONS = 0,
+  TASK_COMMANDS,
+  TASK_SAFETY,
+  TASK_TEMPERATURE,
+  TASK_SPEED_POT,
+  TASK_STATUS,
+  TASK_LEDS
+};
+
+// Order = priority: when several tasks are due, the lowest index runs first.
+// Phase offsets spread the first releases so tasks do not pile up.
+// BTN is also released by the INT0 ISR as soon as a button edge is queued.
+// TEMP and POT have no period: the Timer2 control tick samples their inputs
+// at an exact rate and releases them when a new sample is ready. The TEMP
+// rate adapts to conditions (samplerate.h).
+static const char taskNameButtons[] PROGMEM  = "BTN";
+static const char taskNameCommands[] PROGMEM = "CMD";
+static const char taskNameSafety[] PROGMEM   = "SAFETY";
+static const char taskNameTemp[] PROGMEM     = "TEMP";
+static const char taskNamePot[] PROGMEM      = "POT";
+static const char taskNameStatus[] PROGMEM   = "STATUS";
+static const char taskNameLeds[] PROGMEM     = "LED";
+
+static SchedulerTask tasks[] = {
+  //             name              run              period                      phase  deadline
+  SCHEDULER_TASK(taskNameButtons,  taskButtons,     BUTTON_SETTLE_INTERVAL_MS,  0,     10),
+  SCHEDULER_TASK(taskNameCommands, taskCommands,    COMMAND_POLL_INTERVAL_MS,   3,     20),
+  SCHEDULER_TASK(taskNameSafety,   taskSafety,      SAFETY_CHECK_INTERVAL_MS,   5,     50),
+  SCHEDULER_TASK(taskNameTemp,     taskTemperature, 0,                          0,     100),
+  SCHEDULER_TASK(taskNamePot,      taskSpeedPot,    0,                          0,     50),
+  SCHEDULER_TASK(taskNameStatus,   taskStatus,      STATUS_UPDATE_INTERVAL_MS,  11,    500),
+  SCHEDULER_TASK(taskNameLeds,     taskLEDs,        LED_UPDATE_INTERVAL_MS,     13,    50)
+};
+
 // ============================================================================
 // ARDUINO SETUP FUNCTION
 // ============================================================================
 
 void setup() {
-  // Initialize serial communication for Bluetooth
-  bluetoothInit();
+  // Fast boot: nothing in here waits. Safe-state outputs come first, then
+  // inputs and communication; the boot animation plays from the LED task.
 
-  // Initialize pump hardware
+  // Pump driver outputs to OFF before anything else
   pumpInit();
 
-  // Configure manual control button pin
-  pinMode(BUTTON_TOGGLE_PIN, INPUT_PULLUP);   // Internal pull-up resistor
-
   // Configure optional status LED pins
-  #ifdef LED_POWER_PIN
-    pinMode(LED_POWER_PIN, OUTPUT);
-    digitalWrite(LED_POWER_PIN, HIGH);  // Power LED on
-  #endif
+  ledInit();
+  ledSetBase(LED_ID_POWER, LED_PATTERN_ON);  // Power LED on
 
-  #ifdef LED_BLUETOOTH_PIN
-    pinMode(LED_BLUETOOTH_PIN, OUTPUT);
-    digitalWrite(LED_BLUETOOTH_PIN, LOW);
-  #endif
+  // Analog input pins (temperature channels, speed pot) are configured
+  // by adcEngineInit() below
 
-  // Configure temperature sensor pins (if used)
-  #if !SIMULATE_TEMPERATURE
-    pinMode(TEMP_SENSOR_WATER_PIN, INPUT);
-    pinMode(TEMP_SENSOR_SKIN_PIN, INPUT);
-  #endif
-
-  // Configure speed potentiometer pin
-  pinMode(SPEED_POT_PIN, INPUT);
+  // Initialize serial communication for Bluetooth
+  bluetoothInit(TASK_COMMANDS);
+
+  // Brief startup indication (plays from the LED task, does not block)
+  ledPlay(LED_ID_BLUETOOTH, LED_PATTERN_BOOT);  // 3 blinks to indicate ready
+
+  // Power management (idle sleep statistics start here)
+  powerInit();
+
+  // Start the cooperative scheduler last so first releases are measured from here
+  schedulerInit(tasks, sizeof(tasks) / sizeof(tasks[0]));
+
+  // Arm the watchdog (timeout derived from the task table above)
+  watchdogInit();
+
+  // Button edges are captured by INT0 and release the BTN task
+  buttonInit(TASK_BUTTONS);
+
+  // Free-running oversampled ADC conversions (no analogRead() from here on)
+  adcEngineInit();
+  supplyInit();
+  calibrationInit();
+  sensorsInit();
+  estimatorInit(sensorsGet().skinTemp, sensorsGet().waterTemp);
+
+  // Start fixed-rate sampling; new samples release the TEMP and POT tasks
+  sampleRateInit();
+  thermostatInit();
+  autotuneInit();
+  feedforwardInit();
+  ecoInit();
+  energyInit();
+  controlTickSetNotify(CTRL_CH_TEMPERATURE, TASK_TEMPERATURE);
+  controlTickSetNotify(CTRL_CH_SPEED_POT, TASK_SPEED_POT);
+  controlTickInit();
+
+  // Ready for commands - reported as Boot:<us> by the INFO command
+  bluetoothMarkReady();
+
+  // Tell the app the previous session ended in a stall (details via STALLS)
+  if (watchdogWasReset()) {
+    bluetoothSendError(F("WATCHDOG_RESET"), BT_PRIORITY_SAFETY);
+  }
 
   #if DEBUG_MODE
-    Serial.println(F("[SETUP] Testicool initialization complete"));
-    Serial.println(F("[SETUP] System ready - awaiting commands"));
-    Serial.println(F(""));
+    DEBUG_SERIAL.println(F("[SETUP] Testicool initialization complete"));
+    DEBUG_SERIAL.println(F("[SETUP] System ready - awaiting commands"));
+    DEBUG_SERIAL.println(F(""));
   #endif
-
-  // Brief startup indication
-  blinkLED(LED_BLUETOOTH_PIN, 3, 200);  // 3 blinks to indicate ready
 }
 
 // ============================================================================
@@ -99,98 +190,162 @@ void setup() {
 // ============================================================================
 
 void loop() {
-  // Get current time for non-blocking timing
-  unsigned long currentMillis = millis();
+  watchdogKick();
+
+  // Pending input releases the command task at once instead of at its next
+  // period (on the hardware UART the RX interrupt already does this per line)
+  if (bluetoothHasInput()) {
+    schedulerTrigger(TASK_COMMANDS);
+  }
+
+  // Run whichever task is due - no blocking delay, so button, command and
+  // safety response is bounded by the task periods instead of a fixed sleep.
+  // With nothing due, sleep until the next deadline (tickless idle).
+  if (!schedulerRun()) {
+    powerIdle(schedulerGetIdleTimeUs(), wakeRequested);
+  }
+}
 
-  // ========== 1. CHECK MANUAL BUTTONS ==========
+// Early wake condition for powerIdle(): an ISR released a task (button edge,
+// control tick sample, complete command line) or input is waiting
+bool wakeRequested() {
+  return schedulerHasPendingTrigger() || bluetoothHasInput();
+}
+
+// ============================================================================
+// SCHEDULER TASKS
+// ============================================================================
+
+// ========== 1. CHECK MANUAL BUTTONS ==========
+void taskButtons() {
+  PERF_SCOPE(PERF_LOOP_BUTTONS);
+
+  // Queue any edge hidden by the debounce window, then handle all events
+  buttonSettle();
   checkManualButtons();
+}
+
+// ========== 2. PROCESS BLUETOOTH COMMANDS ==========
+void taskCommands() {
+  PERF_SCOPE(PERF_LOOP_COMMANDS);
 
-  // ========== 2. PROCESS BLUETOOTH COMMANDS ==========
   if (bluetoothProcessCommands()) {
-    // Command was processed - blink BT LED
-    #ifdef LED_BLUETOOTH_PIN
-      digitalWrite(LED_BLUETOOTH_PIN, HIGH);
-      delay(50);
-      digitalWrite(LED_BLUETOOTH_PIN, LOW);
-    #endif
+    // Command was processed - flash BT LED (non-blocking)
+    ledPlay(LED_ID_BLUETOOTH, LED_PATTERN_FLASH);
   }
+}
+
+// ========== 3. SAFETY CHECK ==========
+void taskSafety() {
+  PERF_SCOPE(PERF_LOOP_SAFETY);
+
+  // Follow the supply (battery discharge) with the pump duty
+  supplyUpdate();
+  pumpRefreshDuty();
 
-  // ========== 3. SAFETY CHECK ==========
   // Check pump safety conditions (max runtime, etc.)
   if (pumpCheckSafety()) {
     // Safety shutoff occurred - notify via Bluetooth
-    bluetoothSendError("SAFETY_SHUTOFF");
-    bluetoothSendMessage("Maximum runtime exceeded");
+    errorPattern = LED_PATTERN_SAFETY;
+    bluetoothSendError(F("SAFETY_SHUTOFF"), BT_PRIORITY_SAFETY);
+    bluetoothSendMessage(F("Maximum runtime exceeded"), BT_PRIORITY_SAFETY);
 
     #if DEBUG_MODE
-      Serial.println(F("[MAIN] Safety shutoff triggered"));
+      DEBUG_SERIAL.println(F("[MAIN] Safety shutoff triggered"));
     #endif
   }
+}
 
-  // ========== 4. PERIODIC STATUS UPDATES ==========
-  // Send status update every STATUS_UPDATE_INTERVAL_MS
-  if (currentMillis - lastStatusUpdate >= STATUS_UPDATE_INTERVAL_MS) {
-    lastStatusUpdate = currentMillis;
+// ========== 4. TEMPERATURE MONITORING ==========
+void taskTemperature() {
+  PERF_SCOPE(PERF_LOOP_TEMPERATURE);
 
-    // Only send automatic updates if pump is running
-    if (pumpGetState() == PUMP_ON) {
-      #if DEBUG_MODE
-        Serial.println(F("[MAIN] Sending periodic status update"));
-      #endif
-      bluetoothSendStatus();
-    }
-  }
+  // New snapshot for everyone (STATUS, TEMP) from the same readings
+  sensorsRefresh(CTRL_CH_TEMPERATURE);
 
-  // ========== 5. TEMPERATURE MONITORING ==========
   #if !SIMULATE_TEMPERATURE
-  if (currentMillis - lastTempRead >= TEMP_READ_INTERVAL_MS) {
-    lastTempRead = currentMillis;
-
-    float waterTemp = readWaterTemperature();
-    float skinTemp = readSkinTemperature();
+    // Estimates (updated by the POT task) follow a rise without the lag
+    // of averaging the readings
+    int16_t waterTemp = estimatorGet().waterTemp;
+    int16_t skinTemp = estimatorGet().skinTemp;
 
     // Check for temperature-based safety conditions
     if (skinTemp > OVERHEAT_TEMP_C && pumpGetState() == PUMP_ON) {
       pumpEmergencyStop();
-      bluetoothSendError("OVERHEAT");
-      char msg[64];
-      snprintf(msg, sizeof(msg), "Skin temperature too high: %.1fC", skinTemp);
-      bluetoothSendMessage(msg);
+      errorPattern = LED_PATTERN_OVERHEAT;
+      bluetoothSendError(F("OVERHEAT"), BT_PRIORITY_SAFETY);
+
+      char tempStr[8];
+      bluetoothFormatTemperature(skinTemp, tempStr, sizeof(tempStr));
+      char msg[48];
+      snprintf_P(msg, sizeof(msg), PSTR("Skin temperature too high: %sC"), tempStr);
+      bluetoothSendMessage(msg, BT_PRIORITY_SAFETY);
 
       #if DEBUG_MODE
-        Serial.print(F("[MAIN] OVERHEAT DETECTED: "));
-        Serial.print(skinTemp);
-        Serial.println(F("C"));
+        DEBUG_SERIAL.print(F("[MAIN] OVERHEAT DETECTED: "));
+        DEBUG_SERIAL.print(tempStr);
+        DEBUG_SERIAL.println(F("C"));
       #endif
     }
 
     // Optional: Check if water is too warm (not cooling effectively)
-    if (waterTemp > 30.0 && pumpGetState() == PUMP_ON) {
+    if (waterTemp > WATER_WARM_TEMP_C && pumpGetState() == PUMP_ON) {
       #if DEBUG_MODE
-        Serial.print(F("[WARNING] Water temp: "));
-        Serial.print(waterTemp);
-        Serial.println(F("C - may not cool effectively"));
+        char tempStr[8];
+        DEBUG_SERIAL.print(F("[WARNING] Water temp: "));
+        DEBUG_SERIAL.print(bluetoothFormatTemperature(waterTemp, tempStr, sizeof(tempStr)));
+        DEBUG_SERIAL.println(F("C - may not cool effectively"));
       #endif
     }
-  }
   #endif
+}
 
-  // ========== 6. MANUAL SPEED CONTROL (POTENTIOMETER) ==========
-  // Read potentiometer and adjust pump speed
-  if (currentMillis - lastSpeedRead >= SPEED_READ_INTERVAL_MS) {
-    lastSpeedRead = currentMillis;
+// ========== 5. MANUAL SPEED CONTROL (POTENTIOMETER) ==========
+void taskSpeedPot() {
+  PERF_SCOPE(PERF_LOOP_SPEED_POT);
+
+  sensorsRefresh(CTRL_CH_SPEED_POT);
+
+  // The estimator steps at this task's rate (fixed while the pump runs,
+  // the temperature rate while it is off), and the sampling rates follow
+  // what it sees. The pump cools with the flow after the water
+  // feedforward, which then follows the new water estimate.
+  const SensorSnapshot& sensors = sensorsGet();
+  uint8_t pumpSpeed = HIRES_TO_SPEED(feedforwardApply(pumpGetSpeedHiRes()));
+  estimatorUpdate(sensors.skinTemp, sensors.waterTemp, pumpSpeed, controlTickGetPeriodMs(CTRL_CH_SPEED_POT));
+  sampleRateUpdate(estimatorGet(), pumpGetSpeed());
+  feedforwardUpdate(estimatorGet());
+  pumpRefreshDuty();
+
+  // AUTO / TUNE / ECO: the thermostat sets the speed. MANUAL: only read pot if pump is running
+  thermostatUpdate(estimatorGet());
+  if (pumpGetState() == PUMP_ON && thermostatGetMode() == THERMOSTAT_MANUAL) {
+    checkManualSpeedControl();
+  }
 
-    // Only read pot if pump is running
-    if (pumpGetState() == PUMP_ON) {
-      checkManualSpeedControl();
-    }
+  // Charge the time since the last step to the mode and duty that ran
+  energyUpdate();
+}
+
+// ========== 6. PERIODIC STATUS UPDATES ==========
+void taskStatus() {
+  PERF_SCOPE(PERF_LOOP_STATUS);
+
+  // Only send automatic updates if pump is running
+  if (pumpGetState() == PUMP_ON) {
+    #if DEBUG_MODE
+      DEBUG_SERIAL.println(F("[MAIN] Sending periodic status update"));
+    #endif
+    bluetoothSendStatus();
   }
+}
 
-  // ========== 7. LED STATUS INDICATION ==========
-  updateStatusLEDs();
+// ========== 7. LED STATUS INDICATION ==========
+void taskLEDs() {
+  PERF_SCOPE(PERF_LOOP_LEDS);
 
-  // Small delay for loop stability (non-blocking)
-  delay(LOOP_DELAY_MS);
+  updateStatusLEDs();
+  ledUpdate();
 }
 
 // ============================================================================
@@ -198,42 +353,56 @@ void loop() {
 // ============================================================================
 
 void checkManualButtons() {
-  unsigned long currentMillis = millis();
+  // Drain every edge captured by the INT0 ISR since the last run
+  ButtonEvent event;
 
-  // ========== TOGGLE BUTTON ==========
-  bool buttonState = digitalRead(BUTTON_TOGGLE_PIN);
+  while (buttonPopEvent(&event)) {
+    if (event.type != BUTTON_PRESS) {
+      buttonHeld = false;   // Released before the long hold
+      continue;
+    }
 
-  // Check for button press (LOW = pressed with pull-up resistor)
-  if (buttonState == LOW && lastButtonState == HIGH) {
-    // Debounce check
-    if (currentMillis - lastButtonPress > BUTTON_DEBOUNCE_MS) {
-      lastButtonPress = currentMillis;
+    // Press: toggle at once, then watch for a long hold
+    buttonHeld = true;
+    buttonPressUs = event.timeUs;
 
-      // Toggle pump state
-      PumpState currentState = pumpGetState();
+    // ========== TOGGLE BUTTON ==========
+    PumpState currentState = pumpGetState();
 
-      if (currentState == PUMP_ON) {
-        // Pump is ON, turn it OFF
-        pumpOff();
-        bluetoothSendMessage("MANUAL:OFF");
+    if (currentState == PUMP_ON) {
+      // Pump is ON, turn it OFF
+      pumpOff();
+      bluetoothSendMessage(F("MANUAL:OFF"));
+
+      #if DEBUG_MODE
+        DEBUG_SERIAL.println(F("[BUTTON] Toggle button pressed - Pump OFF"));
+      #endif
+    } else {
+      // Pump is OFF, turn it ON
+      if (pumpOn()) {
+        bluetoothSendMessage(F("MANUAL:ON"));
 
         #if DEBUG_MODE
-          Serial.println(F("[BUTTON] Toggle button pressed - Pump OFF"));
+          DEBUG_SERIAL.println(F("[BUTTON] Toggle button pressed - Pump ON"));
         #endif
-      } else {
-        // Pump is OFF, turn it ON
-        if (pumpOn()) {
-          bluetoothSendMessage("MANUAL:ON");
-
-          #if DEBUG_MODE
-            Serial.println(F("[BUTTON] Toggle button pressed - Pump ON"));
-          #endif
-        }
       }
     }
   }
 
-  lastButtonState = buttonState;
+  // ========== LONG PRESS: MANUAL / AUTO (stops a running autotune) ==========
+  // On top of the toggle the press already did; once per press
+  if (buttonHeld && micros() - buttonPressUs >= BUTTON_LONG_PRESS_MS * 1000UL) {
+    buttonHeld = false;
+    ThermostatMode mode = (thermostatGetMode() == THERMOSTAT_MANUAL) ? THERMOSTAT_AUTO : THERMOSTAT_MANUAL;
+    thermostatSetMode(mode);
+    ledPlay(LED_ID_BLUETOOTH, LED_PATTERN_FLASH);
+
+    char name[THERMOSTAT_MODE_NAME_SIZE];
+    char msg[24];
+    thermostatGetModeName(mode, name, sizeof(name));
+    snprintf_P(msg, sizeof(msg), PSTR("MANUAL:MODE:%s"), name);
+    bluetoothSendMessage(msg);
+  }
 }
 
 // ============================================================================
@@ -241,8 +410,8 @@ void checkManualButtons() {
 // ============================================================================
 
 void checkManualSpeedControl() {
-  // Read potentiometer value (0-1023)
-  int potValue = analogRead(SPEED_POT_PIN);
+  // Potentiometer position from the sensor snapshot (0-1023)
+  int potValue = sensorsGet().potValue;
 
   // Map to pump speed range (0-255)
   // Add small deadzone at bottom to ensure pump can be set to "off" speed
@@ -260,11 +429,11 @@ void checkManualSpeedControl() {
     // Set the new pump speed
     if (pumpSetSpeed(newSpeed)) {
       #if DEBUG_MODE
-        Serial.print(F("[POT] Manual speed adjusted: "));
-        Serial.print(newSpeed);
-        Serial.print(F(" ("));
-        Serial.print((newSpeed * 100) / 255);
-        Serial.println(F("%)"));
+        DEBUG_SERIAL.print(F("[POT] Manual speed adjusted: "));
+        DEBUG_SERIAL.print(newSpeed);
+        DEBUG_SERIAL.print(F(" ("));
+        DEBUG_SERIAL.print((newSpeed * 100) / 255);
+        DEBUG_SERIAL.println(F("%)"));
       #endif
 
       // Send notification via Bluetooth (optional - might be too chatty)
@@ -281,125 +450,19 @@ void checkManualSpeedControl() {
 // ============================================================================
 
 void updateStatusLEDs() {
-  #ifdef LED_POWER_PIN
-    // Power LED always on
-    digitalWrite(LED_POWER_PIN, HIGH);
-  #endif
-
-  #ifdef LED_BLUETOOTH_PIN
-    // Bluetooth LED indicates pump state
-    PumpState state = pumpGetState();
-
-    if (state == PUMP_ON) {
-      // Solid on when pump running
-      digitalWrite(LED_BLUETOOTH_PIN, HIGH);
-    } else if (state == PUMP_ERROR) {
-      // Fast blink when error
-      digitalWrite(LED_BLUETOOTH_PIN, (millis() / 200) % 2);
-    } else {
-      // Off when pump off
-      digitalWrite(LED_BLUETOOTH_PIN, LOW);
-    }
-  #endif
-}
-
-// ============================================================================
-// HELPER FUNCTIONS
-// ============================================================================
-
-void blinkLED(uint8_t pin, uint8_t times, unsigned int delayMs) {
-  #ifdef LED_BLUETOOTH_PIN
-    for (uint8_t i = 0; i < times; i++) {
-      digitalWrite(pin, HIGH);
-      delay(delayMs);
-      digitalWrite(pin, LOW);
-      delay(delayMs);
-    }
-  #endif
-}
-
-#if !SIMULATE_TEMPERATURE
-// NTC 10K Thermistor Parameters
-#define THERMISTOR_NOMINAL 10000.0    // Resistance at 25°C (10kΩ)
-#define TEMPERATURE_NOMINAL 25.0      // Temperature for nominal resistance (25°C)
-#define B_COEFFICIENT 3950.0          // Beta coefficient for NTC thermistor
-#define SERIES_RESISTOR 10000.0       // Value of series resistor (10kΩ)
-
-// Calibration offsets (adjust after testing at known temperature)
-#define WATER_TEMP_OFFSET 0.0   // Adjust if needed
-#define SKIN_TEMP_OFFSET  0.0   // Adjust if needed
-
-// Helper function to read temperature from NTC 10K thermistor
-float readThermistorTemperature(int pin) {
-  // Read analog value from thermistor
-  int rawValue = analogRead(pin);
-
-  // Avoid edge cases
-  if (rawValue <= 1) rawValue = 1;
-  if (rawValue >= 1022) rawValue = 1022;
-
-  // Calculate resistance of thermistor
-  // WIRING: Thermistor to +5V, Resistor to GND
-  // Voltage divider: Vout = Vin * (R_series / (R_series + R_thermistor))
-  // Therefore: R_thermistor = R_series * ((1023/ADC) - 1)
-  float adcFloat = (float)rawValue;
-  float resistance = SERIES_RESISTOR * ((1023.0 / adcFloat) - 1.0);
-
-  // Steinhart-Hart equation (simplified B-parameter equation)
-  // 1/T = 1/T0 + (1/B) * ln(R/R0)
-  float steinhart;
-  steinhart = resistance / THERMISTOR_NOMINAL;              // (R/Ro)
-  steinhart = log(steinhart);                               // ln(R/Ro)
-  steinhart /= B_COEFFICIENT;                               // 1/B * ln(R/Ro)
-  steinhart += 1.0 / (TEMPERATURE_NOMINAL + 273.15);        // + (1/To) in Kelvin
-  steinhart = 1.0 / steinhart;                              // Invert to get Kelvin
-  steinhart -= 273.15;                                      // Convert to Celsius
-
-  return steinhart;
-}
-
-float readWaterTemperature() {
-  float temp = readThermistorTemperature(TEMP_SENSOR_WATER_PIN);
-  return temp + WATER_TEMP_OFFSET;  // Apply calibration offset
-}
-
-float readSkinTemperature() {
-  float temp = readThermistorTemperature(TEMP_SENSOR_SKIN_PIN);
-  return temp + SKIN_TEMP_OFFSET;   // Apply calibration offset
-}
-#endif
-
-// ============================================================================
-// INTERRUPT SERVICE ROUTINES (Optional Enhancement)
-// ============================================================================
-
-// Uncomment and modify if you want to use hardware interrupts for buttons
-// This provides faster, more reliable button response
-
-/*
-void buttonOnISR() {
-  static unsigned long lastInterrupt = 0;
-  unsigned long currentTime = millis();
-
-  // Debounce
-  if (currentTime - lastInterrupt > BUTTON_DEBOUNCE_MS) {
-    lastInterrupt = currentTime;
-    pumpOn();
-  }
-}
-
-void buttonOffISR() {
-  static unsigned long lastInterrupt = 0;
-  unsigned long currentTime = millis();
-
-  // Debounce
-  if (currentTime - lastInterrupt > BUTTON_DEBOUNCE_MS) {
-    lastInterrupt = currentTime;
-    pumpOff();
+  // Bluetooth LED base pattern follows pump state; command flashes and the
+  // boot animation play on top of it (see leds.h)
+  PumpState state = pumpGetState();
+
+  if (state == PUMP_ON) {
+    // Solid on when pump running
+    ledSetBase(LED_ID_BLUETOOTH, LED_PATTERN_ON);
+  } else if (state == PUMP_ERROR) {
+    // Blink code of the error cause
+    ledSetBase(LED_ID_BLUETOOTH, errorPattern);
+  } else {
+    // Off when pump off
+    ledSetBase(LED_ID_BLUETOOTH, LED_PATTERN_OFF);
+    errorPattern = LED_PATTERN_ERROR;
   }
 }
-
-// In setup(), add:
-// attachInterrupt(digitalPinToInterrupt(BUTTON_ON_PIN), buttonOnISR, FALLING);
-// attachInterrupt(digitalPinToInterrupt(BUTTON_OFF_PIN), buttonOffISR, FALLING);
-*/
@@ -0,0 +1,273 @@
+/*
+ * adcengine.cpp
+ * Interrupt-driven ADC engine implementation for Testicool device
+ *
+ * Conversions are chained from ADC_vect as single conversions (ADSC) rather
+ * than in the ADATE free-running mode: in free-running mode the next
+ * conversion has already started with the old ADMUX when the interrupt
+ * runs, so every input switch would cost an extra, mislabelled sample.
+ *
+ * Timing at the Arduino core's ADC clock (16 MHz / 128 = 125 kHz):
+ *   one conversion ~ 13.5 ADC clocks = 108 us
+ *   one reading    = (1 + 4^ADC_OVERSAMPLE_BITS) conversions (1.8 ms at n = 2)
+ *   one cycle      = ADC_INPUT_COUNT readings (8.3 ms at n = 2 with two
+ *                    temperature channels, the pot and the bandgap, whose
+ *                    reading waits BANDGAP_SETTLE_CONVERSIONS instead of one;
+ *                    + 1.8 ms per extra channel or the pump supply divider)
+ *
+ * On demand, a burst of ADC_BURST_CYCLES cycles takes ADC_BURST_US
+ * (133 ms at the defaults); the cycle it was started in counts as one.
+ *
+ * The bandgap is selected through ADMUX like a pin; its reference output
+ * needs about a millisecond to settle each time it is switched in.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "adcengine.h"
+#include "uart.h"
+#include "filter.h"
+#include <util/atomic.h>
+
+#define OVERSAMPLE_COUNT  (1U << (2 * ADC_OVERSAMPLE_BITS))   // 4^n
+#define MUX_BANDGAP       0x0E                                 // ADMUX channel of the 1.1 V bandgap
+#define MUX_PIN(pin)      (((pin) >= A0) ? (pin) - A0 : (pin))
+#define ADC_PRESCALER     (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))  // clk/128 = 125 kHz
+
+static_assert(ADC_OVERSAMPLE_BITS <= 3, "ADC_OVERSAMPLE_BITS above 3 overflows the 16-bit accumulator");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// ADMUX channels and names (flash), indexed by AdcInput. The names are a
+// fixed-width table because TEMP_CHANNELS gives them as literals; a name
+// too long for ADC_INPUT_NAME_SIZE fails to compile
+#define CHANNEL_MUX(name, pin, role, offset)   MUX_PIN(pin),
+#define CHANNEL_NAME(name, pin, role, offset)  name,
+
+static const uint8_t inputMux[ADC_INPUT_COUNT] = {
+  TEMP_CHANNELS(CHANNEL_MUX) MUX_PIN(SPEED_POT_PIN),
+#if PUMP_SUPPLY_SENSE_ENABLED
+  MUX_PIN(PUMP_SUPPLY_PIN),
+#endif
+  MUX_BANDGAP
+};
+
+static const char inputNames[ADC_INPUT_COUNT][ADC_INPUT_NAME_SIZE] PROGMEM = {
+  TEMP_CHANNELS(CHANNEL_NAME) "POT",
+#if PUMP_SUPPLY_SENSE_ENABLED
+  "SUPPLY",
+#endif
+  "BANDGAP"
+};
+
+static volatile uint16_t results[ADC_INPUT_COUNT];    // Filtered readings (ISR -> main)
+static SampleFilter filters[ADC_INPUT_COUNT];         // Written by the ISR
+static volatile unsigned long cycleCount = 0;
+
+// On-demand mode (set from the control tick)
+static volatile bool onDemand = false;
+static volatile bool converting = false;                // Converter enabled and chained
+static volatile uint8_t burstLeft = 0;                  // Cycles still to run on demand
+
+// ISR-only conversion state
+static uint8_t currentInput = 0;
+static uint8_t discardLeft = 1;                         // Settling conversions after a switch
+static uint16_t accumulator = 0;
+static uint8_t accumulated = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+// AVcc reference, same as analogRead(); arms the settling discard
+static inline void selectInput(uint8_t input) {
+  ADMUX = _BV(REFS0) | (inputMux[input] & 0x0F);
+  discardLeft = (input == ADC_INPUT_BANDGAP) ? BANDGAP_SETTLE_CONVERSIONS : 1;
+}
+
+// Enable the converter and start the first conversion of the chain; it is
+// an extended one (25 ADC clocks) and falls into the settling discard
+static inline void startConverter() {
+  ADCSRA = _BV(ADEN) | _BV(ADIF) | _BV(ADIE) | ADC_PRESCALER | _BV(ADSC);
+  converting = true;
+}
+
+// Switched off between bursts, which also saves its supply current
+static inline void stopConverter() {
+  ADCSRA = _BV(ADIF) | ADC_PRESCALER;
+  converting = false;
+}
+
+// One blocking conversion (settling discards included), before the
+// interrupt chain starts
+static uint16_t convertOnce(uint8_t input) {
+  selectInput(input);
+  uint16_t sample = 0;
+  for (uint8_t i = 0; i <= discardLeft; i++) {
+    ADCSRA |= _BV(ADSC);
+    while (ADCSRA & _BV(ADSC)) {
+    }
+    sample = ADC;
+  }
+  return sample;
+}
+
+// ============================================================================
+// ADC ENGINE INITIALIZATION
+// ============================================================================
+
+void adcEngineInit() {
+  ADCSRB = 0;
+  ADCSRA = _BV(ADEN) | _BV(ADIF) | ADC_PRESCALER;       // Polled for the priming conversions
+
+  // Prime every input with one plain reading so consumers never see 0
+  for (uint8_t i = 0; i < ADC_INPUT_COUNT; i++) {
+    if (inputMux[i] != MUX_BANDGAP) {
+      pinMode(A0 + inputMux[i], INPUT);
+    }
+    results[i] = convertOnce(i) << ADC_OVERSAMPLE_BITS;
+    filterReset(&filters[i], results[i]);
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    currentInput = 0;
+    accumulator = 0;
+    accumulated = 0;
+
+    selectInput(currentInput);
+    startConverter();                                   // Clears the stale flag, interrupt on completion
+  }
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[ADC] Engine started - "));
+    DEBUG_SERIAL.print(ADC_RESULT_BITS);
+    DEBUG_SERIAL.println(F("-bit readings"));
+  #endif
+}
+
+// ============================================================================
+// CONVERSION COMPLETE INTERRUPT
+// ============================================================================
+
+ISR(ADC_vect) {
+  uint16_t sample = ADC;
+
+  if (discardLeft > 0) {
+    discardLeft--;
+  } else {
+    accumulator += sample;
+    if (++accumulated == OVERSAMPLE_COUNT) {
+      // Decimate: 4^n samples summed, n bits dropped -> n extra bits kept
+      results[currentInput] = filterAdd(&filters[currentInput], accumulator >> ADC_OVERSAMPLE_BITS);
+      accumulator = 0;
+      accumulated = 0;
+
+      if (++currentInput >= ADC_INPUT_COUNT) {
+        currentInput = 0;
+        cycleCount++;
+
+        // On demand: stop after the last cycle of a burst, first input selected
+        if (onDemand && (burstLeft == 0 || --burstLeft == 0)) {
+          selectInput(currentInput);
+          stopConverter();
+          return;
+        }
+      }
+      selectInput(currentInput);
+    }
+  }
+
+  ADCSRA |= _BV(ADSC);   // Next conversion
+}
+
+// ============================================================================
+// ON-DEMAND MODE
+// ============================================================================
+
+void adcEngineSetOnDemand(bool enable) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    onDemand = enable;
+    burstLeft = 0;
+    if (!enable && !converting) {
+      startConverter();
+    }
+  }
+}
+
+void adcEngineBurstFromISR() {
+  if (!onDemand) {
+    return;
+  }
+  burstLeft = ADC_BURST_CYCLES;
+  if (!converting) {
+    startConverter();
+  }
+}
+
+// ============================================================================
+// READING ACCESS
+// ============================================================================
+
+uint16_t adcEngineGetValue(uint8_t input) {
+  if (input >= ADC_INPUT_COUNT) {
+    return 0;
+  }
+
+  uint16_t value;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    value = results[input];
+  }
+  return value;
+}
+
+uint16_t adcEngineGetValueFromISR(uint8_t input) {
+  return (input < ADC_INPUT_COUNT) ? results[input] : 0;
+}
+
+unsigned long adcEngineGetCycleCount() {
+  unsigned long count;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    count = cycleCount;
+  }
+  return count;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* adcEngineGetInputName(uint8_t input, char* buffer, size_t bufferSize) {
+  if (input >= ADC_INPUT_COUNT || buffer == NULL || bufferSize < ADC_INPUT_NAME_SIZE) {
+    return NULL;
+  }
+
+  strncpy_P(buffer, inputNames[input], bufferSize - 1);
+  buffer[bufferSize - 1] = '\0';
+  return buffer;
+}
+
+char* adcEngineGetInputString(uint8_t input, char* buffer, size_t bufferSize) {
+  if (input >= ADC_INPUT_COUNT || buffer == NULL || bufferSize < 60) {
+    return NULL;
+  }
+
+  char name[ADC_INPUT_NAME_SIZE];
+  adcEngineGetInputName(input, name, sizeof(name));
+
+  uint16_t raw;
+  uint16_t filtered;
+  uint32_t variance;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    raw = filters[input].raw;
+    filtered = results[input];
+    variance = filters[input].variance;
+  }
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("FILTER:%s,Raw:%u,Filtered:%u,Var:%lu"),
+             name, raw, filtered, (unsigned long)variance);
+
+  return buffer;
+}
@@ -0,0 +1,121 @@
+/*
+ * adcengine.h
+ * Interrupt-driven ADC engine header for Testicool device
+ *
+ * The converter runs continuously, chained from its own completion
+ * interrupt, and visits the analog inputs round-robin:
+ * - The first conversion after each input switch is discarded (the
+ *   sample-and-hold capacitor settles through the sensor's impedance)
+ * - The next 4^ADC_OVERSAMPLE_BITS conversions are summed and decimated
+ *   into one reading with ADC_OVERSAMPLE_BITS extra bits of resolution
+ * - The reading goes through the input's filter (filter.h), the result
+ *   is published and the next input is selected
+ *
+ * Nothing ever waits for a conversion; readers get the latest finished
+ * reading of an input. Oversampling only gains resolution with about one
+ * LSB of noise on the input, which the thermistor dividers have.
+ *
+ * When every control tick channel samples slowly (ADC_ON_DEMAND_MIN_MS),
+ * the converter runs on demand instead: the tick starts a burst of
+ * ADC_BURST_CYCLES cycles just before each sample instant and the ADC is
+ * switched off in between, so its ~9 kHz interrupt no longer wakes the
+ * idle sleep. Readings then come from the last burst.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef ADCENGINE_H
+#define ADCENGINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Inputs visited by the engine, in round-robin order: the temperature
+// channels (TEMP_CHANNELS in config.h, input = channel index), the pot,
+// the pump supply divider if fitted, and the internal 1.1 V bandgap
+enum AdcInput {
+  ADC_INPUT_POT = TEMP_CHANNEL_COUNT,   // Speed potentiometer (SPEED_POT_PIN)
+#if PUMP_SUPPLY_SENSE_ENABLED
+  ADC_INPUT_PUMP_SUPPLY,                // Pump supply divider (PUMP_SUPPLY_PIN)
+#endif
+  ADC_INPUT_BANDGAP,                    // Bandgap against AVcc (supply.h)
+  ADC_INPUT_COUNT
+};
+
+#define ADC_RESULT_BITS   (10 + ADC_OVERSAMPLE_BITS)    // Bits per reading
+#define ADC_RESULT_MAX    (1023U << ADC_OVERSAMPLE_BITS) // Full-scale reading
+#define ADC_INPUT_NAME_SIZE  8                         // Longest input name + terminator
+
+// Conversions per engine cycle and the length of a burst (see adcengine.cpp)
+#define ADC_CONVERSION_US     108
+#define ADC_CYCLE_CONVERSIONS (ADC_INPUT_COUNT * (1 + (1U << (2 * ADC_OVERSAMPLE_BITS))) + BANDGAP_SETTLE_CONVERSIONS - 1)
+#define ADC_BURST_US          ((unsigned long)ADC_BURST_CYCLES * ADC_CYCLE_CONVERSIONS * ADC_CONVERSION_US)
+
+// ============================================================================
+// ADC ENGINE FUNCTIONS
+// ============================================================================
+
+/**
+ * Start the ADC engine
+ * Takes one plain conversion of every input first, so readings are valid
+ * at once; after that the converter runs on its own. Call once in setup().
+ * The ADC belongs to the engine from then on - nothing may call analogRead().
+ */
+void adcEngineInit();
+
+/**
+ * Get the latest filtered reading of one input
+ * @param input: temperature channel index or another AdcInput
+ * @return oversampled reading, 0 to ADC_RESULT_MAX (ADC_RESULT_BITS bits)
+ */
+uint16_t adcEngineGetValue(uint8_t input);
+
+/**
+ * Get the latest filtered reading without disabling interrupts
+ * Only for callers that already run with interrupts disabled (ISRs)
+ * @param input: temperature channel index or another AdcInput
+ * @return oversampled reading, 0 to ADC_RESULT_MAX
+ */
+uint16_t adcEngineGetValueFromISR(uint8_t input);
+
+/**
+ * Run the converter continuously or only in bursts
+ * Switching to on demand stops the converter at the end of its current
+ * cycle; switching back starts it at once. The control tick decides.
+ * @param enable: true = only in bursts (adcEngineBurstFromISR()), false = continuously
+ */
+void adcEngineSetOnDemand(bool enable);
+
+/**
+ * Run ADC_BURST_CYCLES more cycles, starting the converter if it is off
+ * Ignored while running continuously
+ * Only for callers that already run with interrupts disabled (ISRs)
+ */
+void adcEngineBurstFromISR();
+
+/**
+ * Get the number of completed round-robin cycles (every input read once)
+ * @return cycle counter (wraps)
+ */
+unsigned long adcEngineGetCycleCount();
+
+/**
+ * Copy the name of an input (the TEMP_CHANNELS name, "POT", "SUPPLY" or "BANDGAP")
+ * @param input: temperature channel index or another AdcInput
+ * @param buffer: character array to store the name
+ * @param bufferSize: size of buffer array, at least ADC_INPUT_NAME_SIZE
+ * @return pointer to buffer, NULL for an invalid input
+ */
+char* adcEngineGetInputName(uint8_t input, char* buffer, size_t bufferSize);
+
+/**
+ * Format the filter state of one input (readings in ADC_RESULT_BITS units)
+ * Format: "FILTER:<name>,Raw:<reading>,Filtered:<reading>,Var:<reading^2>"
+ * @param input: temperature channel index or another AdcInput
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* adcEngineGetInputString(uint8_t input, char* buffer, size_t bufferSize);
+
+#endif // ADCENGINE_H
@@ -0,0 +1,346 @@
+/*
+ * autotune.cpp
+ * Relay-feedback autotuner implementation for Testicool device
+ *
+ * All in integers: temperatures in hundredths of a degree, periods in
+ * milliseconds. The Ziegler-Nichols constants are folded into the 16.16
+ * gain units of thermostat.h:
+ *
+ *   kp = 0.6 Ku * 65536 / 100         = 0.6 * 4 * 65536 / pi * d / a  = 50066 d / a
+ *   ki = kp * PERIOD / Ti             = kp * PERIOD_MS * 2 / Tu_ms
+ *   kd = kp * 100 * Td / 1000 (m°C/s) = kp * Tu_ms / 80000
+ *
+ * with d the relay half-swing in duty and a the corrected amplitude in
+ * hundredths of a degree.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "autotune.h"
+#include "config.h"
+#include "uart.h"
+#include "pump.h"
+#include "thermostat.h"
+#include "bluetooth.h"
+#include "eepromwrite.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#define TUNE_RECORD_VERSION  1
+#define RELAY_HALF_SWING     ((AUTOTUNE_DUTY_HIGH - AUTOTUNE_DUTY_LOW) / 2)
+#define KP_PER_SWING         50066L     // 0.6 * 4 * 65536 / pi
+#define KU_PER_SWING         12732L     // 4 * 100 * 100 / pi, Ku in hundredths of duty per degree
+
+static constexpr int16_t HYSTERESIS = CENTI_C(AUTOTUNE_HYSTERESIS_C);
+
+static_assert(AUTOTUNE_DUTY_LOW < AUTOTUNE_DUTY_HIGH && AUTOTUNE_DUTY_HIGH <= PUMP_MAX_SPEED,
+              "AUTOTUNE_DUTY_LOW must be below AUTOTUNE_DUTY_HIGH");
+static_assert(HYSTERESIS > 0, "AUTOTUNE_HYSTERESIS_C must be positive");
+static_assert(AUTOTUNE_CYCLES >= 1, "AUTOTUNE_CYCLES must be at least 1");
+
+// ============================================================================
+// STATE NAMES (flash)
+// ============================================================================
+
+static const char nameIdle[] PROGMEM    = "IDLE";
+static const char nameRunning[] PROGMEM = "RUNNING";
+static const char nameDone[] PROGMEM    = "DONE";
+static const char nameFailed[] PROGMEM  = "FAILED";
+
+// Indexed by AutotuneState
+static const char* const stateNames[] PROGMEM = { nameIdle, nameRunning, nameDone, nameFailed };
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// EEPROM layout
+struct TuneRecord {
+  uint8_t version;
+  ThermostatGains gains;
+  uint16_t crc;              // CRC-16 of everything above
+};
+
+static AutotuneState state = AUTOTUNE_IDLE;
+static PGM_P failReason = NULL;      // Flash string, NULL unless FAILED
+static uint8_t speedBefore = 0;      // Restored when the test does not finish
+
+static uint32_t startMs = 0;
+static uint32_t elapsedMs = 0;       // Frozen when the test ends
+static bool relayHigh = false;
+static bool cycleStarted = false;    // A high switch has been seen
+static uint32_t cycleStartMs = 0;
+static int16_t cycleMax = 0;
+static int16_t cycleMin = 0;
+static uint8_t cyclesSeen = 0;       // Complete cycles, including the skipped first one
+static uint32_t sumPeriodMs = 0;
+static uint32_t sumAmplitude = 0;
+
+// Result
+static uint16_t kuHundredths = 0;
+static uint32_t tuMs = 0;
+
+static TuneRecord stored;    // Source of the background EEPROM write (eepromwrite.h)
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static uint16_t recordCrc(const TuneRecord* record) {
+  const uint8_t* bytes = (const uint8_t*)record;
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < offsetof(TuneRecord, crc); i++) {
+    crc = _crc16_update(crc, bytes[i]);
+  }
+  return crc;
+}
+
+static uint16_t isqrt(uint32_t value) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint16_t)root;
+}
+
+static void setRelay(bool high) {
+  relayHigh = high;
+  pumpSetSpeed(high ? AUTOTUNE_DUTY_HIGH : AUTOTUNE_DUTY_LOW);
+}
+
+static void stop(PGM_P reason) {
+  state = AUTOTUNE_FAILED;
+  failReason = reason;
+  elapsedMs = millis() - startMs;
+  pumpSetSpeed(speedBefore);       // Ignored if the pump is off
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[TUNE] Failed: "));
+    DEBUG_SERIAL.println(reinterpret_cast<const __FlashStringHelper*>(reason));
+  #endif
+}
+
+// Stop for a reason the user did not cause, and tell the app
+static void fail(PGM_P reason) {
+  stop(reason);
+  thermostatSetMode(THERMOSTAT_MANUAL);
+
+  char msg[96];
+  if (autotuneGetStatusString(msg, sizeof(msg)) != NULL) {
+    bluetoothSendMessage(msg);
+  }
+}
+
+// Derive, store and apply the gains from the averaged cycles
+static void finish() {
+  uint16_t amplitude = (uint16_t)(sumAmplitude / AUTOTUNE_CYCLES);
+  tuMs = sumPeriodMs / AUTOTUNE_CYCLES;
+
+  if (amplitude <= HYSTERESIS) {
+    fail(PSTR("AMPLITUDE"));   // Oscillation lost in the hysteresis: relay too weak
+    return;
+  }
+
+  // Hysteresis correction: the relay switches eps after the crossing
+  uint16_t effective = isqrt((uint32_t)amplitude * amplitude - (uint32_t)HYSTERESIS * HYSTERESIS);
+  if (effective == 0) {
+    effective = 1;
+  }
+  kuHundredths = (uint16_t)min(KU_PER_SWING * RELAY_HALF_SWING / effective, 65535L);
+
+  ThermostatGains gains;
+  gains.kp = KP_PER_SWING * RELAY_HALF_SWING / effective;
+  gains.ki = (int32_t)((int64_t)gains.kp * THERMOSTAT_PERIOD_MS * 2 / (int64_t)tuMs);
+  gains.kd = (int32_t)((int64_t)gains.kp * tuMs / 80000);
+
+  // ~3.4 ms per changed byte - written in the background, not in the POT task
+  stored.version = TUNE_RECORD_VERSION;
+  stored.gains = gains;
+  stored.crc = recordCrc(&stored);
+  eepromWriteStart(EEPROM_RECORD_AUTOTUNE, TUNE_EEPROM_ADDR, &stored, sizeof(stored));
+
+  state = AUTOTUNE_DONE;
+  elapsedMs = millis() - startMs;
+  thermostatSetGains(gains, THERMOSTAT_GAINS_TUNED);
+  thermostatSetMode(THERMOSTAT_AUTO);
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[TUNE] Done - Ku x100: "));
+    DEBUG_SERIAL.print(kuHundredths);
+    DEBUG_SERIAL.print(F(", Tu: "));
+    DEBUG_SERIAL.print(tuMs);
+    DEBUG_SERIAL.println(F(" ms"));
+  #endif
+
+  char msg[96];
+  if (autotuneGetStatusString(msg, sizeof(msg)) != NULL) {
+    bluetoothSendMessage(msg);
+  }
+}
+
+// ============================================================================
+// AUTOTUNE
+// ============================================================================
+
+void autotuneInit() {
+  TuneRecord record;
+  eeprom_read_block(&record, (const void*)TUNE_EEPROM_ADDR, sizeof(record));
+
+  bool valid = record.version == TUNE_RECORD_VERSION && record.crc == recordCrc(&record);
+  if (valid) {
+    thermostatSetGains(record.gains, THERMOSTAT_GAINS_TUNED);
+  }
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(valid ? F("[TUNE] Tuned gains loaded from EEPROM")
+                               : F("[TUNE] No stored gains - using defaults"));
+  #endif
+}
+
+bool autotuneStart() {
+  if (pumpGetState() != PUMP_ON) {
+    return false;
+  }
+
+  if (state != AUTOTUNE_RUNNING) {
+    speedBefore = pumpGetSpeed();
+  }
+  state = AUTOTUNE_RUNNING;
+  failReason = NULL;
+  startMs = millis();
+  elapsedMs = 0;
+  cycleStarted = false;
+  cyclesSeen = 0;
+  sumPeriodMs = 0;
+  sumAmplitude = 0;
+  kuHundredths = 0;
+  tuMs = 0;
+
+  setRelay(false);                 // First high switch marks the first cycle
+  thermostatSetMode(THERMOSTAT_TUNE);
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(F("[TUNE] Relay test started"));
+  #endif
+
+  return true;
+}
+
+void autotuneStep(const ThermalEstimate& estimate) {
+  if (state != AUTOTUNE_RUNNING) {
+    return;
+  }
+  if (pumpGetState() != PUMP_ON) {
+    fail(PSTR("PUMP_OFF"));
+    return;
+  }
+
+  uint32_t now = millis();
+  if (now - startMs >= AUTOTUNE_TIMEOUT_MS) {
+    fail(PSTR("TIMEOUT"));
+    return;
+  }
+
+  int16_t skin = estimate.skinTemp;
+  int16_t target = thermostatGetTarget();
+  cycleMax = max(cycleMax, skin);
+  cycleMin = min(cycleMin, skin);
+
+  // Reverse acting: more flow cools the skin
+  if (!relayHigh && skin > target + HYSTERESIS) {
+    if (cycleStarted) {
+      // The first cycle starts from wherever the skin was; skip it
+      if (cyclesSeen > 0) {
+        sumPeriodMs += now - cycleStartMs;
+        sumAmplitude += (uint16_t)(cycleMax - cycleMin) / 2;
+      }
+      cyclesSeen++;
+    }
+    cycleStarted = true;
+    cycleStartMs = now;
+    cycleMax = skin;
+    cycleMin = skin;
+    setRelay(true);
+
+    if (cyclesSeen > AUTOTUNE_CYCLES) {
+      finish();
+    }
+  } else if (relayHigh && skin < target - HYSTERESIS) {
+    setRelay(false);
+  }
+}
+
+void autotuneCancel() {
+  if (state == AUTOTUNE_RUNNING) {
+    stop(PSTR("STOPPED"));
+  }
+}
+
+void autotuneReset() {
+  autotuneCancel();
+  if (thermostatGetMode() == THERMOSTAT_TUNE) {
+    thermostatSetMode(THERMOSTAT_MANUAL);
+  }
+
+  // A version byte that never matches invalidates the record (and
+  // replaces a save still being written)
+  stored.version = 0xFF;
+  eepromWriteStart(EEPROM_RECORD_AUTOTUNE, TUNE_EEPROM_ADDR, &stored.version, 1);
+  thermostatResetGains();
+  state = AUTOTUNE_IDLE;
+  failReason = NULL;
+}
+
+AutotuneState autotuneGetState() {
+  return state;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* autotuneGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 96) {
+    return NULL;
+  }
+
+  uint32_t elapsed = (state == AUTOTUNE_RUNNING) ? millis() - startMs : elapsedMs;
+  uint8_t measured = (cyclesSeen > 0) ? cyclesSeen - 1 : 0;
+
+  char kuStr[10];
+  char tuStr[10];
+  if (state == AUTOTUNE_DONE) {
+    snprintf_P(kuStr, sizeof(kuStr), PSTR("%u.%02u"), kuHundredths / 100, kuHundredths % 100);
+    snprintf_P(tuStr, sizeof(tuStr), PSTR("%lus"), (tuMs + 500) / 1000);
+  } else {
+    strcpy_P(kuStr, PSTR("-"));
+    strcpy_P(tuStr, PSTR("-"));
+  }
+
+  char stateStr[8];
+  strncpy_P(stateStr, (const char*)pgm_read_ptr(&stateNames[state]), sizeof(stateStr) - 1);
+  stateStr[sizeof(stateStr) - 1] = '\0';
+
+  int length = snprintf_P(buffer, bufferSize, PSTR("TUNE:{State:%s,Cycles:%u/%u,Time:%lus,Ku:%s,Tu:%s"),
+                          stateStr, min(measured, (uint8_t)AUTOTUNE_CYCLES), AUTOTUNE_CYCLES,
+                          elapsed / 1000, kuStr, tuStr);
+  if (failReason != NULL && length > 0 && (size_t)length < bufferSize) {
+    char reasonStr[12];
+    strncpy_P(reasonStr, failReason, sizeof(reasonStr) - 1);
+    reasonStr[sizeof(reasonStr) - 1] = '\0';
+    snprintf_P(buffer + length, bufferSize - length, PSTR(",Error:%s}"), reasonStr);
+  } else if (length > 0 && (size_t)length < bufferSize) {
+    snprintf_P(buffer + length, bufferSize - length, PSTR("}"));
+  }
+  return buffer;
+}
@@ -0,0 +1,97 @@
+/*
+ * autotune.h
+ * Relay-feedback autotuner header for Testicool device
+ *
+ * How hard the pump has to work depends on the wearer, the tubing length
+ * and how full the reservoir is, so fixed gains fit few sessions. The
+ * autotuner measures the loop instead (Astrom-Hagglund relay test):
+ *
+ * - The pump is switched between AUTOTUNE_DUTY_LOW and AUTOTUNE_DUTY_HIGH
+ *   around the target skin temperature: high once the skin is
+ *   AUTOTUNE_HYSTERESIS_C above the target, low once it is that far below
+ * - The skin settles into a steady oscillation; its period Tu and
+ *   amplitude a are averaged over AUTOTUNE_CYCLES cycles (the first, from
+ *   wherever the skin started, is skipped)
+ * - The ultimate gain follows from the relay amplitude d:
+ *
+ *     Ku = 4 d / (pi * sqrt(a^2 - eps^2))
+ *
+ * - The Ziegler-Nichols PID rules give the gains:
+ *
+ *     Kp = 0.6 Ku,  Ti = Tu / 2,  Td = Tu / 8
+ *
+ * The result is stored in EEPROM (CRC-protected, after the calibration
+ * record) and loaded at boot; the thermostat then switches to AUTO with
+ * the new gains. A test takes a few oscillation periods, typically a few
+ * minutes, and gives up after AUTOTUNE_TIMEOUT_MS.
+ *
+ * The tune runs in THERMOSTAT_TUNE mode with the pump on. Switching mode
+ * or turning the pump off stops it and keeps the previous gains.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <Arduino.h>
+#include "estimator.h"
+
+// Autotuner progress
+enum AutotuneState {
+  AUTOTUNE_IDLE = 0,         // Not run since boot
+  AUTOTUNE_RUNNING,          // Relay test in progress
+  AUTOTUNE_DONE,             // Gains derived, stored and in use
+  AUTOTUNE_FAILED            // Stopped; previous gains kept (see the status string)
+};
+
+// ============================================================================
+// AUTOTUNE FUNCTIONS
+// ============================================================================
+
+/**
+ * Load stored gains into the thermostat, if there is a valid record
+ * Call once in setup(), after thermostatInit()
+ */
+void autotuneInit();
+
+/**
+ * Start a relay test (switches the thermostat to TUNE mode)
+ * @return true if started, false if the pump is not running
+ */
+bool autotuneStart();
+
+/**
+ * Step the relay test
+ * Called by thermostatUpdate() on every estimator step in TUNE mode
+ * @param estimate: latest thermal estimate
+ */
+void autotuneStep(const ThermalEstimate& estimate);
+
+/**
+ * Stop a running test (the thermostat calls this when TUNE mode is left)
+ */
+void autotuneCancel();
+
+/**
+ * Return to the config.h gains and invalidate the stored record
+ */
+void autotuneReset();
+
+/**
+ * Get the current state
+ * @return AutotuneState
+ */
+AutotuneState autotuneGetState();
+
+/**
+ * Get the test progress and result as formatted string
+ * Format: "TUNE:{State:<state>,Cycles:<n>/<N>,Time:<s>,Ku:<duty/C>,Tu:<s>[,Error:<reason>]}"
+ * (Ku and Tu show "-" until measured)
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* autotuneGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // AUTOTUNE_H
@@ -11,40 +11,95 @@
 #include "bluetooth.h"
 #include "config.h"
 #include "pump.h"
+#include "scheduler.h"
+#include "controltick.h"
+#include "power.h"
+#include "button.h"
+#include "perf.h"
+#include "watchdog.h"
+#include "cmdqueue.h"
+#include "uart.h"
+#include "adcengine.h"
+#include "filter.h"
+#include "sensors.h"
+#include "estimator.h"
+#include "samplerate.h"
+#include "calibration.h"
+#include "supply.h"
+#include "thermostat.h"
+#include "autotune.h"
+#include "feedforward.h"
+#include "eco.h"
+#include "energy.h"
 
 #if USE_SOFTWARE_SERIAL
   #include <SoftwareSerial.h>
   SoftwareSerial BTSerial(BT_RX_PIN, BT_TX_PIN); // RX, TX
   #define BT_SERIAL BTSerial
 #else
-  #define BT_SERIAL Serial
+  #define BT_SERIAL BtUart      // Own USART driver - Serial must not be linked in
 #endif
 
+#if !USE_SOFTWARE_SERIAL
+static_assert((int)BT_PRIORITY_SAFETY == (int)UART_TX_SAFETY &&
+              (int)BT_PRIORITY_REPLY == (int)UART_TX_REPLY &&
+              (int)BT_PRIORITY_TELEMETRY == (int)UART_TX_TELEMETRY, "BtPriority must match UartTxClass");
+#endif
+
+// Formats line `index` of a multi-line report, NULL to skip it
+typedef char* (*ReportLineFn)(uint8_t index, char* buffer, size_t bufferSize);
+
+// Longest STATUS line + terminator: "STATUS:{" (8), pump state with 5-digit
+// runtime and remaining minutes (51), two temperatures (2 x 17), a 10-digit
+// age (16), sample rate (17), supply (14), "V}" (2). Realistic lines are
+// about 125 characters; the rest is headroom so snprintf never truncates.
+#define STATUS_LINE_SIZE  144
+
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
 
 static void processCommand(const char* cmd);
-
-// Forward declarations for temperature functions defined in Testicool.ino
-#if !SIMULATE_TEMPERATURE
-extern float readWaterTemperature();
-extern float readSkinTemperature();
+static void processCalibrationCapture(const char* args);
+static bool parseCentiCelsius(const char* text, int16_t* centi);
+static void startReport(ReportLineFn lineFn, uint8_t lineCount);
+static void continueReport();
+static char* formatStatus(char* buffer, size_t bufferSize);
+static void continueStatus();
+static char* tickReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* stallReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* rxReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* filterReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* calReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* sensorReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* tuneReportLine(uint8_t index, char* buffer, size_t bufferSize);
+static char* energyReportLine(uint8_t index, char* buffer, size_t bufferSize);
+#if PERF_ENABLED
+static char* perfReportLine(uint8_t index, char* buffer, size_t bufferSize);
 #endif
 
 // ============================================================================
 // PRIVATE VARIABLES
 // ============================================================================
 
-static char commandBuffer[64];     // Buffer for incoming commands
-static uint8_t bufferIndex = 0;    // Current position in buffer
-static unsigned long lastStatusSend = 0;
+static unsigned long bootReadyUs = 0;     // Reset -> command-ready time (0 = still booting)
+
+// Multi-line report in progress (TASKS, PERF, ...), sent as reply space frees up
+static ReportLineFn reportLineFn = NULL;
+static uint8_t reportNext = 0;
+static uint8_t reportCount = 0;
+
+// STATUS reply waiting for room in the reply buffer
+static bool statusPending = false;
 
 // ============================================================================
 // BLUETOOTH INITIALIZATION
 // ============================================================================
 
-void bluetoothInit() {
+void bluetoothInit(uint8_t commandTask) {
+  // Complete lines release the command task
+  cmdQueueInit(commandTask);
+
   // Initialize serial communication for Bluetooth module
   #if USE_SOFTWARE_SERIAL
     // Using SoftwareSerial (not used with DSD TECH)
@@ -52,32 +107,27 @@ void bluetoothInit() {
     // Also initialize hardware Serial for debug output
     #if DEBUG_MODE
       Serial.begin(9600);
-      delay(100);
-      Serial.println(F(""));
-      Serial.println(F("========================================"));
-      Serial.println(F("  TESTICOOL BLUETOOTH INITIALIZED"));
-      Serial.println(F("========================================"));
-      Serial.println(F("Mode: SoftwareSerial (legacy)"));
-      Serial.print(F("Device: "));
-      Serial.println(F(DEVICE_NAME));
-      Serial.print(F("Version: "));
-      Serial.println(F(FIRMWARE_VERSION));
-      Serial.print(F("Baud Rate: "));
-      Serial.println(BLUETOOTH_BAUD_RATE);
-      Serial.println(F("========================================"));
-      Serial.println(F("Ready for commands..."));
-      Serial.println(F(""));
+      DEBUG_SERIAL.println(F(""));
+      DEBUG_SERIAL.println(F("========================================"));
+      DEBUG_SERIAL.println(F("  TESTICOOL BLUETOOTH INITIALIZED"));
+      DEBUG_SERIAL.println(F("========================================"));
+      DEBUG_SERIAL.println(F("Mode: SoftwareSerial (legacy)"));
+      DEBUG_SERIAL.print(F("Device: "));
+      DEBUG_SERIAL.println(F(DEVICE_NAME));
+      DEBUG_SERIAL.print(F("Version: "));
+      DEBUG_SERIAL.println(F(FIRMWARE_VERSION));
+      DEBUG_SERIAL.print(F("Baud Rate: "));
+      DEBUG_SERIAL.println(BLUETOOTH_BAUD_RATE);
+      DEBUG_SERIAL.println(F("========================================"));
+      DEBUG_SERIAL.println(F("Ready for commands..."));
+      DEBUG_SERIAL.println(F(""));
     #endif
   #else
     // Using hardware Serial on D0/D1 (DSD TECH BLE module)
-    Serial.begin(BLUETOOTH_BAUD_RATE);
-    delay(100);
-    // No debug output available when using hardware Serial for Bluetooth
+    // No settle delay needed - the UART is usable as soon as it is enabled
+    uartInit(BLUETOOTH_BAUD_RATE);
+    // Debug output (DEBUG_SERIAL) shares the Bluetooth link in this mode
   #endif
-
-  // Clear buffer
-  memset(commandBuffer, 0, sizeof(commandBuffer));
-  bufferIndex = 0;
 }
 
 // ============================================================================
@@ -85,47 +135,40 @@ void bluetoothInit() {
 // ============================================================================
 
 bool bluetoothProcessCommands() {
-  // Check if data is available
-  if (!BT_SERIAL.available()) {
-    return false;
-  }
-
-  // Read incoming bytes
-  while (BT_SERIAL.available()) {
-    char inChar = BT_SERIAL.read();
+  #if USE_SOFTWARE_SERIAL
+    // No RX interrupt of our own here - feed the line assembler from the task
+    while (BT_SERIAL.available()) {
+      cmdQueueReceive(BT_SERIAL.read());
+    }
+  #endif
 
-    // Check for command terminator (newline or carriage return)
-    if (inChar == '\n' || inChar == '\r') {
-      if (bufferIndex > 0) {
-        commandBuffer[bufferIndex] = '\0';  // Null-terminate string
+  // Keep a pending STATUS and a multi-line report going before taking new commands
+  continueStatus();
+  continueReport();
 
-        // Process the command
-        processCommand(commandBuffer);
+  if (!cmdQueueHasLine()) {
+    return false;
+  }
 
-        // Clear buffer for next command
-        memset(commandBuffer, 0, sizeof(commandBuffer));
-        bufferIndex = 0;
+  PERF_SCOPE(PERF_BT_PROCESS);
 
-        return true;
-      }
-    }
-    // Add character to buffer if there's space
-    else if (bufferIndex < sizeof(commandBuffer) - 1) {
-      commandBuffer[bufferIndex++] = inChar;
-    }
-    // Buffer overflow protection
-    else {
+  // Drain every complete line, so a burst (ON, SPEED, STATUS) is handled
+  // in one pass instead of one line per task period
+  bool tooLong = false;
+  const char* line;
+  while ((line = cmdQueuePeek(&tooLong)) != NULL) {
+    if (tooLong) {
       #if DEBUG_MODE
-        Serial.println(F("[BT] ERROR: Command buffer overflow"));
+        DEBUG_SERIAL.println(F("[BT] ERROR: Command too long"));
       #endif
-      memset(commandBuffer, 0, sizeof(commandBuffer));
-      bufferIndex = 0;
-      bluetoothSendError("CMD_TOO_LONG");
-      return false;
+      bluetoothSendError(F("CMD_TOO_LONG"));
+    } else {
+      processCommand(line);
     }
+    cmdQueuePop();
   }
 
-  return false;
+  return true;
 }
 
 // ============================================================================
@@ -133,13 +176,15 @@ bool bluetoothProcessCommands() {
 // ============================================================================
 
 static void processCommand(const char* cmd) {
+  PERF_SCOPE(PERF_BT_COMMAND);
+
   #if DEBUG_MODE
-    Serial.print(F("[BT] Received command: "));
-    Serial.println(cmd);
+    DEBUG_SERIAL.print(F("[BT] Received command: "));
+    DEBUG_SERIAL.println(cmd);
   #endif
 
   // Convert command to uppercase for case-insensitive comparison
-  char upperCmd[64];
+  char upperCmd[CMD_SLOT_SIZE];
   strncpy(upperCmd, cmd, sizeof(upperCmd) - 1);
   upperCmd[sizeof(upperCmd) - 1] = '\0';
 
@@ -148,93 +193,546 @@ static void processCommand(const char* cmd) {
   }
 
   // ========== ON COMMAND ==========
-  if (strcmp(upperCmd, "ON") == 0) {
+  if (strcmp_P(upperCmd, PSTR("ON")) == 0) {
     if (pumpOn()) {
       bluetoothSendOK();
-      bluetoothSendMessage("PUMP:ON");
+      bluetoothSendMessage(F("PUMP:ON"));
       #if DEBUG_MODE
-        Serial.println(F("[BT] Command: Pump turned ON"));
+        DEBUG_SERIAL.println(F("[BT] Command: Pump turned ON"));
       #endif
     } else {
-      bluetoothSendError("PUMP_START_FAILED");
+      bluetoothSendError(F("PUMP_START_FAILED"));
     }
   }
 
   // ========== OFF COMMAND ==========
-  else if (strcmp(upperCmd, "OFF") == 0) {
+  else if (strcmp_P(upperCmd, PSTR("OFF")) == 0) {
     pumpOff();
     bluetoothSendOK();
-    bluetoothSendMessage("PUMP:OFF");
+    bluetoothSendMessage(F("PUMP:OFF"));
     #if DEBUG_MODE
-      Serial.println(F("[BT] Command: Pump turned OFF"));
+      DEBUG_SERIAL.println(F("[BT] Command: Pump turned OFF"));
     #endif
   }
 
   // ========== STATUS COMMAND ==========
-  else if (strcmp(upperCmd, "STATUS") == 0) {
-    bluetoothSendStatus();
+  else if (strcmp_P(upperCmd, PSTR("STATUS")) == 0) {
+    // Nearly the whole reply buffer: it waits for room there, like a
+    // report line, instead of being dropped behind earlier replies
+    statusPending = true;
+    continueStatus();
     #if DEBUG_MODE
-      Serial.println(F("[BT] Command: Status requested"));
+      DEBUG_SERIAL.println(F("[BT] Command: Status requested"));
     #endif
   }
 
   // ========== TEMP COMMAND ==========
-  else if (strcmp(upperCmd, "TEMP") == 0) {
-    #if SIMULATE_TEMPERATURE
-      float waterTemp = SIMULATED_WATER_TEMP_C;
-      float skinTemp = SIMULATED_SKIN_TEMP_C;
-    #else
-      float waterTemp = readWaterTemperature();
-      float skinTemp = readSkinTemperature();
-    #endif
-
-    // Send both temperatures
-    // Note: Arduino's snprintf doesn't support %f, so we use dtostrf
-    char waterTempStr[10];
-    char skinTempStr[10];
-    dtostrf(waterTemp, 4, 1, waterTempStr);
-    dtostrf(skinTemp, 4, 1, skinTempStr);
+  else if (strcmp_P(upperCmd, PSTR("TEMP")) == 0) {
+    // Send both temperatures from the shared snapshot, with its age
+    const SensorSnapshot& sensors = sensorsGet();
+    char waterTempStr[8];
+    char skinTempStr[8];
+    bluetoothFormatTemperature(sensors.waterTemp, waterTempStr, sizeof(waterTempStr));
+    bluetoothFormatTemperature(sensors.skinTemp, skinTempStr, sizeof(skinTempStr));
 
     char tempMsg[64];
-    snprintf(tempMsg, sizeof(tempMsg), "TEMP:{Water:%sC,Skin:%sC}", waterTempStr, skinTempStr);
-    BT_SERIAL.println(tempMsg);
+    snprintf_P(tempMsg, sizeof(tempMsg), PSTR("TEMP:{Water:%sC,Skin:%sC,Age:%lums}"),
+               waterTempStr, skinTempStr, sensorsGetAgeMs());
+    bluetoothSendMessage(tempMsg);
+
+    #if DEBUG_MODE
+      DEBUG_SERIAL.println(F("[BT] Command: Temperature requested"));
+    #endif
+  }
+
+  // ========== EST COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("EST")) == 0) {
+    // Estimated temperatures and rates of change (thousandths of a degree per second)
+    const ThermalEstimate& thermal = estimatorGet();
+    char waterTempStr[8];
+    char skinTempStr[8];
+    bluetoothFormatTemperature(thermal.waterTemp, waterTempStr, sizeof(waterTempStr));
+    bluetoothFormatTemperature(thermal.skinTemp, skinTempStr, sizeof(skinTempStr));
+
+    char estMsg[96];
+    snprintf_P(estMsg, sizeof(estMsg),
+               PSTR("EST:{Skin:%sC,SkinRate:%dmC/s,Water:%sC,WaterRate:%dmC/s,Cooling:%dmC/s}"),
+               skinTempStr, thermal.skinRate, waterTempStr, thermal.waterRate, thermal.coolingRate);
+    bluetoothSendMessage(estMsg);
 
     #if DEBUG_MODE
-      Serial.println(F("[BT] Command: Temperature requested"));
+      DEBUG_SERIAL.println(F("[BT] Command: Estimate requested"));
     #endif
   }
 
   // ========== SPEED COMMAND ==========
-  else if (strncmp(upperCmd, "SPEED:", 6) == 0) {
+  else if (strncmp_P(upperCmd, PSTR("SPEED:"), 6) == 0) {
     // Parse speed value
     int speed = atoi(upperCmd + 6);
 
-    if (speed >= 0 && speed <= 255) {
+    if (thermostatGetMode() != THERMOSTAT_MANUAL) {
+      // The thermostat owns the speed: name the mode, e.g. ERROR:ECO_MODE
+      char modeError[THERMOSTAT_MODE_NAME_SIZE + 5];
+      thermostatGetModeName(thermostatGetMode(), modeError, sizeof(modeError));
+      strcat_P(modeError, PSTR("_MODE"));
+      bluetoothSendError(modeError);
+    } else if (speed >= 0 && speed <= 255) {
       if (pumpSetSpeed((uint8_t)speed)) {
         bluetoothSendOK();
         char msg[32];
-        snprintf(msg, sizeof(msg), "SPEED:%d", speed);
+        snprintf_P(msg, sizeof(msg), PSTR("SPEED:%d"), speed);
         bluetoothSendMessage(msg);
         #if DEBUG_MODE
-          Serial.print(F("[BT] Command: Speed set to "));
-          Serial.println(speed);
+          DEBUG_SERIAL.print(F("[BT] Command: Speed set to "));
+          DEBUG_SERIAL.println(speed);
         #endif
       } else {
-        bluetoothSendError("PUMP_NOT_RUNNING");
+        bluetoothSendError(F("PUMP_NOT_RUNNING"));
       }
     } else {
-      bluetoothSendError("INVALID_SPEED_VALUE");
+      bluetoothSendError(F("INVALID_SPEED_VALUE"));
     }
   }
 
+  // ========== MODE COMMANDS ==========
+  else if (strcmp_P(upperCmd, PSTR("MODE")) == 0) {
+    char modeMsg[112];
+    thermostatGetStatusString(modeMsg, sizeof(modeMsg));
+    bluetoothSendMessage(modeMsg);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("MODE:AUTO")) == 0 || strcmp_P(upperCmd, PSTR("MODE:MANUAL")) == 0 ||
+           strcmp_P(upperCmd, PSTR("MODE:ECO")) == 0) {
+    ThermostatMode mode = (upperCmd[5] == 'A') ? THERMOSTAT_AUTO :
+                          (upperCmd[5] == 'E') ? THERMOSTAT_ECO : THERMOSTAT_MANUAL;
+    thermostatSetMode(mode);
+    bluetoothSendOK();
+    char name[THERMOSTAT_MODE_NAME_SIZE];
+    char msg[24];
+    thermostatGetModeName(mode, name, sizeof(name));
+    snprintf_P(msg, sizeof(msg), PSTR("MODE:%s"), name);
+    bluetoothSendMessage(msg);
+  }
+
+  // ========== ECO COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("ECO")) == 0) {
+    char ecoMsg[112];
+    ecoGetStatusString(ecoMsg, sizeof(ecoMsg));
+    bluetoothSendMessage(ecoMsg);
+  }
+
+  // ========== ENERGY COMMANDS ==========
+  else if (strcmp_P(upperCmd, PSTR("ENERGY")) == 0) {
+    // One line per control mode: on time, duty cycle, energy, battery life
+    startReport(energyReportLine, energyGetModeCount());
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("ENERGY:RESET")) == 0) {
+    energyReset();
+    bluetoothSendOK();
+  }
+
+  // ========== TUNE COMMANDS ==========
+  else if (strcmp_P(upperCmd, PSTR("TUNE")) == 0) {
+    // Autotuner state, gains in use, settling time per gain set
+    startReport(tuneReportLine, 3);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("TUNE:START")) == 0) {
+    if (autotuneStart()) {
+      bluetoothSendOK();
+      bluetoothSendMessage(F("MODE:TUNE"));
+    } else {
+      bluetoothSendError(F("PUMP_NOT_RUNNING"));
+    }
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("TUNE:STOP")) == 0) {
+    if (thermostatGetMode() == THERMOSTAT_TUNE) {
+      thermostatSetMode(THERMOSTAT_MANUAL);
+      bluetoothSendOK();
+      bluetoothSendMessage(F("MODE:MANUAL"));
+    } else {
+      bluetoothSendError(F("NOT_TUNING"));
+    }
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("TUNE:RESET")) == 0) {
+    autotuneReset();
+    bluetoothSendOK();
+  }
+
+  // ========== INFO COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("INFO")) == 0) {
+    char infoMsg[80];
+    bluetoothGetDeviceInfo(infoMsg, sizeof(infoMsg));
+    bluetoothSendMessage(infoMsg);
+  }
+
+  // ========== TASKS COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("TASKS")) == 0) {
+    // One line per scheduler task with its lateness statistics
+    startReport(schedulerGetTaskStatsString, schedulerGetTaskCount());
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("TASKS:RESET")) == 0) {
+    schedulerResetStats();
+    bluetoothSendOK();
+  }
+
+  // ========== TICK COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("TICK")) == 0) {
+    // One line per control tick channel with its sample-interval jitter
+    startReport(tickReportLine, CTRL_CH_COUNT);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("TICK:RESET")) == 0) {
+    controlTickResetStats();
+    bluetoothSendOK();
+  }
+
+  // ========== SUPPLY COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("SUPPLY")) == 0) {
+    char supplyMsg[64];
+    supplyGetStatusString(supplyMsg, sizeof(supplyMsg));
+    bluetoothSendMessage(supplyMsg);
+  }
+
+  // ========== FEEDFORWARD COMMANDS ==========
+  else if (strcmp_P(upperCmd, PSTR("FF")) == 0) {
+    char ffMsg[64];
+    feedforwardGetStatusString(ffMsg, sizeof(ffMsg));
+    bluetoothSendMessage(ffMsg);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("FF:ON")) == 0 || strcmp_P(upperCmd, PSTR("FF:OFF")) == 0) {
+    feedforwardSetEnabled(upperCmd[4] == 'N');
+    pumpRefreshDuty();
+    bluetoothSendOK();
+  }
+
+  // ========== POWER COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("POWER")) == 0) {
+    char powerMsg[96];
+    powerGetStatusString(powerMsg, sizeof(powerMsg));
+    bluetoothSendMessage(powerMsg);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("POWER:RESET")) == 0) {
+    powerResetStats();
+    bluetoothSendOK();
+  }
+
+  // ========== BUTTON COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("BUTTON")) == 0) {
+    char buttonMsg[64];
+    buttonGetStatusString(buttonMsg, sizeof(buttonMsg));
+    bluetoothSendMessage(buttonMsg);
+  }
+
+  // ========== STALLS COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("STALLS")) == 0) {
+    // Summary, then the persistent stall records, oldest first
+    startReport(stallReportLine, 1 + watchdogGetRecordCount());
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("STALLS:CLEAR")) == 0) {
+    watchdogClearRecords();
+    bluetoothSendOK();
+  }
+
+  // ========== RX COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("RX")) == 0) {
+    startReport(rxReportLine, 2);
+  }
+
+  // ========== FILTER COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("FILTER")) == 0) {
+    // One line per ADC input: latest raw and filtered reading, noise variance
+    startReport(filterReportLine, ADC_INPUT_COUNT);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("FILTER:BENCH")) == 0) {
+    char benchMsg[80];
+    filterGetBenchmarkString(benchMsg, sizeof(benchMsg));
+    bluetoothSendMessage(benchMsg);
+  }
+
+  // ========== SENSORS COMMAND ==========
+  else if (strcmp_P(upperCmd, PSTR("SENSORS")) == 0) {
+    // One line per temperature channel: name, role, calibrated temperature
+    startReport(sensorReportLine, TEMP_CHANNEL_COUNT);
+  }
+
+  // ========== CAL COMMANDS ==========
+  else if (strcmp_P(upperCmd, PSTR("CAL")) == 0) {
+    // One line per channel: coefficients, captured points, where they came from
+    startReport(calReportLine, TEMP_CHANNEL_COUNT);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("CAL:SAVE")) == 0) {
+    CalResult result = calibrationSave();
+    if (result == CAL_OK) {
+      bluetoothSendOK();
+      startReport(calReportLine, TEMP_CHANNEL_COUNT);
+    } else {
+      bluetoothSendError(calibrationGetResultString(result));
+    }
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("CAL:RESET")) == 0) {
+    calibrationReset();
+    bluetoothSendOK();
+  }
+
+  else if (strncmp_P(upperCmd, PSTR("CAL:"), 4) == 0) {
+    processCalibrationCapture(upperCmd + 4);
+  }
+
+  // ========== PERF COMMAND ==========
+  #if PERF_ENABLED
+  else if (strcmp_P(upperCmd, PSTR("PERF")) == 0) {
+    // CPU busy summary, then one line per profiled stage
+    startReport(perfReportLine, 1 + PERF_STAGE_COUNT);
+  }
+
+  else if (strcmp_P(upperCmd, PSTR("PERF:RESET")) == 0) {
+    perfReset();
+    bluetoothSendOK();
+  }
+  #endif
+
   // ========== UNKNOWN COMMAND ==========
   else {
-    bluetoothSendError("UNKNOWN_COMMAND");
+    bluetoothSendError(F("UNKNOWN_COMMAND"));
     #if DEBUG_MODE
-      Serial.print(F("[BT] ERROR: Unknown command: "));
-      Serial.println(cmd);
+      DEBUG_SERIAL.print(F("[BT] ERROR: Unknown command: "));
+      DEBUG_SERIAL.println(cmd);
+    #endif
+  }
+}
+
+// ============================================================================
+// PRIVATE HELPER: CALIBRATION CAPTURE
+// ============================================================================
+
+// "[<channel>:]LOW:<celsius>" or "...HIGH:<celsius>", channel by name or
+// index; no channel = all channels
+static void processCalibrationCapture(const char* args) {
+  uint8_t first = 0;
+  uint8_t last = TEMP_CHANNEL_COUNT;
+  if (isdigit(args[0]) && args[1] == ':') {
+    first = args[0] - '0';
+    if (first >= TEMP_CHANNEL_COUNT) {
+      bluetoothSendError(F("INVALID_CHANNEL"));
+      return;
+    }
+    last = first + 1;
+    args += 2;
+  } else {
+    for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+      char name[ADC_INPUT_NAME_SIZE];
+      adcEngineGetInputName(i, name, sizeof(name));
+      size_t length = strlen(name);
+      if (strncmp(args, name, length) == 0 && args[length] == ':') {
+        first = i;
+        last = i + 1;
+        args += length + 1;
+        break;
+      }
+    }
+  }
+
+  CalPoint point;
+  if (strncmp_P(args, PSTR("LOW:"), 4) == 0) {
+    point = CAL_POINT_LOW;
+    args += 4;
+  } else if (strncmp_P(args, PSTR("HIGH:"), 5) == 0) {
+    point = CAL_POINT_HIGH;
+    args += 5;
+  } else {
+    bluetoothSendError(F("UNKNOWN_COMMAND"));
+    return;
+  }
+
+  int16_t reference;
+  if (!parseCentiCelsius(args, &reference)) {
+    bluetoothSendError(F("INVALID_CAL_TEMP"));
+    return;
+  }
+
+  for (uint8_t channel = first; channel < last; channel++) {
+    CalResult result = calibrationCapture(channel, point, reference);
+    if (result != CAL_OK) {
+      bluetoothSendError(calibrationGetResultString(result));
+      return;
+    }
+  }
+
+  bluetoothSendOK();
+  startReport(calReportLine, TEMP_CHANNEL_COUNT);
+}
+
+// "[-]<degrees>[.<one or two digits>]", up to 300 degrees
+static bool parseCentiCelsius(const char* text, int16_t* centi) {
+  bool negative = (*text == '-');
+  if (negative) {
+    text++;
+  }
+  if (!isdigit(*text)) {
+    return false;
+  }
+
+  int16_t value = 0;
+  while (isdigit(*text)) {
+    value = value * 10 + (*text++ - '0');
+    if (value > 300) {
+      return false;
+    }
+  }
+  value *= 100;
+
+  if (*text == '.') {
+    text++;
+    if (isdigit(*text)) {
+      value += (*text++ - '0') * 10;
+      if (isdigit(*text)) {
+        value += *text++ - '0';
+      }
+    }
+  }
+  if (*text != '\0') {
+    return false;
+  }
+
+  *centi = negative ? -value : value;
+  return true;
+}
+
+// ============================================================================
+// PRIVATE HELPER: MULTI-LINE REPORTS
+// ============================================================================
+
+// Report lines are only queued while the reply buffer has room for them,
+// so long dumps are paced by the UART instead of dropped or blocking
+
+static char* tickReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  return controlTickGetStatsString((ControlChannel)index, buffer, bufferSize);
+}
+
+static char* stallReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  if (index == 0) {
+    return watchdogGetSummaryString(buffer, bufferSize);
+  }
+  return watchdogGetRecordString(index - 1, buffer, bufferSize);
+}
+
+static char* rxReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  if (index == 0) {
+    return cmdQueueGetStatusString(buffer, bufferSize);
+  }
+  #if !USE_SOFTWARE_SERIAL
+    return uartGetStatusString(buffer, bufferSize);
+  #else
+    return NULL;
+  #endif
+}
+
+static char* filterReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  return adcEngineGetInputString(index, buffer, bufferSize);
+}
+
+static char* calReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  return calibrationGetStatusString(index, buffer, bufferSize);
+}
+
+static char* sensorReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  char name[ADC_INPUT_NAME_SIZE];
+  char role[6];
+  char tempStr[8];
+  adcEngineGetInputName(index, name, sizeof(name));
+  sensorsGetRoleName(sensorsGetRole(index), role, sizeof(role));
+  bluetoothFormatTemperature(sensorsGet().temps[index], tempStr, sizeof(tempStr));
+  snprintf_P(buffer, bufferSize, PSTR("SENSOR:%u,Name:%s,Role:%s,Temp:%sC"),
+             index, name, role, tempStr);
+  return buffer;
+}
+
+static char* tuneReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  switch (index) {
+    case 0:  return autotuneGetStatusString(buffer, bufferSize);
+    case 1:  return thermostatGetGainsString(buffer, bufferSize);
+    default: return thermostatGetSettleString(buffer, bufferSize);
+  }
+}
+
+static char* energyReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  return energyGetModeString(index, buffer, bufferSize);
+}
+
+#if PERF_ENABLED
+static char* perfReportLine(uint8_t index, char* buffer, size_t bufferSize) {
+  if (index == 0) {
+    return perfGetSummaryString(buffer, bufferSize);
+  }
+  return perfGetStageString(index - 1, buffer, bufferSize);
+}
+#endif
+
+static void startReport(ReportLineFn lineFn, uint8_t lineCount) {
+  if (reportLineFn != NULL) {
+    bluetoothSendError(F("BUSY"));   // Previous report still being sent
+    return;
+  }
+
+  reportLineFn = lineFn;
+  reportNext = 0;
+  reportCount = lineCount;
+  continueReport();
+}
+
+static void continueReport() {
+  while (reportLineFn != NULL && reportNext < reportCount) {
+    char line[112];
+    if (reportLineFn(reportNext, line, sizeof(line)) == NULL) {
+      reportNext++;
+      continue;
+    }
+
+    #if !USE_SOFTWARE_SERIAL
+      if (uartGetTxFree(UART_TX_REPLY) < strlen(line) + 2) {
+        return;   // Try again on the next command task run
+      }
     #endif
+
+    bluetoothSendMessage(line);
+    reportNext++;
   }
+
+  reportLineFn = NULL;
+}
+
+// Formatted when there is room, so the reply carries the latest values
+static void continueStatus() {
+  if (!statusPending) {
+    return;
+  }
+
+  char statusMsg[STATUS_LINE_SIZE];
+  formatStatus(statusMsg, sizeof(statusMsg));
+
+  #if !USE_SOFTWARE_SERIAL
+    // A line longer than the whole buffer can never fit: it goes on to
+    // uartSendLine(), which drops and counts it (TxDrop), instead of
+    // staying pending forever
+    size_t needed = strlen(statusMsg) + 2;
+    if (needed <= UART_TX_REPLY_SIZE && uartGetTxFree(UART_TX_REPLY) < needed) {
+      return;   // Try again on the next command task run
+    }
+  #endif
+
+  statusPending = false;
+  bluetoothSendMessage(statusMsg);
 }
 
 // ============================================================================
@@ -242,82 +740,145 @@ static void processCommand(const char* cmd) {
 // ============================================================================
 
 void bluetoothSendStatus() {
+  PERF_SCOPE(PERF_BT_SEND_STATUS);
+
+  char statusMsg[STATUS_LINE_SIZE];
+  formatStatus(statusMsg, sizeof(statusMsg));
+  bluetoothSendMessage(statusMsg, BT_PRIORITY_TELEMETRY);
+}
+
+static char* formatStatus(char* buffer, size_t bufferSize) {
   // Get pump status
-  char pumpStatus[100];
+  char pumpStatus[56];
   pumpGetStatusString(pumpStatus, sizeof(pumpStatus));
 
-  // Get both temperatures
-  #if SIMULATE_TEMPERATURE
-    float waterTemp = SIMULATED_WATER_TEMP_C;
-    float skinTemp = SIMULATED_SKIN_TEMP_C;
-  #else
-    float waterTemp = readWaterTemperature();
-    float skinTemp = readSkinTemperature();
-
-    #if DEBUG_MODE
-      Serial.print(F("[BT] Water temp: "));
-      Serial.print(waterTemp);
-      Serial.print(F("C, Skin temp: "));
-      Serial.print(skinTemp);
-      Serial.println(F("C"));
-    #endif
+  // Both temperatures from the estimator (one decimal place); TEMP sends the readings
+  const ThermalEstimate& thermal = estimatorGet();
+  char waterTempStr[8];
+  char skinTempStr[8];
+  bluetoothFormatTemperature(thermal.waterTemp, waterTempStr, sizeof(waterTempStr));
+  bluetoothFormatTemperature(thermal.skinTemp, skinTempStr, sizeof(skinTempStr));
+
+  #if DEBUG_MODE && !SIMULATE_TEMPERATURE
+    DEBUG_SERIAL.print(F("[BT] Water temp: "));
+    DEBUG_SERIAL.print(waterTempStr);
+    DEBUG_SERIAL.print(F("C, Skin temp: "));
+    DEBUG_SERIAL.print(skinTempStr);
+    DEBUG_SERIAL.println(F("C"));
   #endif
 
-  // Format complete status message with both temperatures
-  // Note: Arduino's snprintf doesn't support %f, so we use dtostrf to convert floats
-  char waterTempStr[10];
-  char skinTempStr[10];
-  dtostrf(waterTemp, 4, 1, waterTempStr);  // Convert float to string with 1 decimal place
-  dtostrf(skinTemp, 4, 1, skinTempStr);
+  // Current adaptive temperature sampling rate
+  char rateStr[8];
+  sampleRateFormatHz(rateStr, sizeof(rateStr));
+
+  // Measured supply: the pump supply if a divider is fitted, else AVcc
+  char voltsStr[8];
+  uint16_t pumpMv = supplyGetPumpMv();
+  bool pumpSensed = (pumpMv >= PUMP_SUPPLY_MIN_MV);
+  supplyFormatVolts(pumpSensed ? pumpMv : supplyGetVccMv(), voltsStr, sizeof(voltsStr));
 
-  char statusMsg[180];
-  snprintf(statusMsg, sizeof(statusMsg),
-           "STATUS:{%s,WaterTemp:%sC,SkinTemp:%sC}",
-           pumpStatus, waterTempStr, skinTempStr);
+  char sourceStr[8];
+  strcpy_P(sourceStr, pumpSensed ? PSTR("Supply") : PSTR("Vcc"));
 
-  BT_SERIAL.println(statusMsg);
+  snprintf_P(buffer, bufferSize,
+             PSTR("STATUS:{%s,WaterTemp:%sC,SkinTemp:%sC,Age:%lums,Sample:%s,%s:%sV}"),
+             pumpStatus, waterTempStr, skinTempStr, sensorsGetAgeMs(), rateStr,
+             sourceStr, voltsStr);
 
-  lastStatusSend = millis();
+  return buffer;
 }
 
-void bluetoothSendTemperature(float temperature) {
-  // Note: Arduino's snprintf doesn't support %f, so we use dtostrf
-  char tempStr[10];
-  dtostrf(temperature, 4, 1, tempStr);
+void bluetoothSendTemperature(int16_t temperature) {
+  char tempStr[8];
+  bluetoothFormatTemperature(temperature, tempStr, sizeof(tempStr));
 
   char tempMsg[32];
-  snprintf(tempMsg, sizeof(tempMsg), "TEMP:%s", tempStr);
-  BT_SERIAL.println(tempMsg);
+  snprintf_P(tempMsg, sizeof(tempMsg), PSTR("TEMP:%s"), tempStr);
+  bluetoothSendMessage(tempMsg);
+}
+
+char* bluetoothFormatTemperature(int16_t temperature, char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 8) {
+    return NULL;
+  }
+
+  // Round to tenths, half away from zero (the digits dtostrf used to print)
+  uint16_t magnitude = (temperature < 0) ? (uint16_t)(-(int32_t)temperature) : (uint16_t)temperature;
+  uint16_t tenths = (magnitude + 5) / 10;
+
+  snprintf_P(buffer, bufferSize,
+             (temperature < 0 && tenths != 0) ? PSTR("-%u.%u") : PSTR("%u.%u"),
+             tenths / 10,
+             tenths % 10);
+
+  return buffer;
 }
 
 void bluetoothSendOK() {
-  BT_SERIAL.println(F("OK"));
+  bluetoothSendMessage(F("OK"));
+}
+
+void bluetoothSendError(const char* errorMsg, BtPriority priority) {
+  char msg[48];
+  snprintf_P(msg, sizeof(msg), PSTR("ERROR:%s"), errorMsg);
+  bluetoothSendMessage(msg, priority);
+}
+
+void bluetoothSendError(const __FlashStringHelper* errorMsg, BtPriority priority) {
+  char text[41];
+  strncpy_P(text, reinterpret_cast<PGM_P>(errorMsg), sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  bluetoothSendError(text, priority);
 }
 
-void bluetoothSendError(const char* errorMsg) {
-  BT_SERIAL.print(F("ERROR:"));
-  BT_SERIAL.println(errorMsg);
+void bluetoothSendMessage(const char* message, BtPriority priority) {
+  PERF_SCOPE(PERF_BT_WRITE);
+
+  #if USE_SOFTWARE_SERIAL
+    // SoftwareSerial has no transmit interrupt - this still blocks
+    BT_SERIAL.println(message);
+  #else
+    // Queued and sent by the UDRE interrupt; returns immediately
+    uartSendLine(priority, message);
+  #endif
 }
 
-void bluetoothSendMessage(const char* message) {
-  BT_SERIAL.println(message);
+void bluetoothSendMessage(const __FlashStringHelper* message, BtPriority priority) {
+  char text[48];
+  strncpy_P(text, reinterpret_cast<PGM_P>(message), sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  bluetoothSendMessage(text, priority);
 }
 
 bool bluetoothIsConnected() {
   // Simple heuristic: if we're receiving data, assume connected
   // More sophisticated connection detection would require
   // module-specific AT commands or handshaking
-  return BT_SERIAL.available() > 0;
+  return bluetoothHasInput();
+}
+
+bool bluetoothHasInput() {
+  #if USE_SOFTWARE_SERIAL
+    return cmdQueueHasLine() || BT_SERIAL.available() > 0;
+  #else
+    return cmdQueueHasLine();
+  #endif
+}
+
+void bluetoothMarkReady() {
+  // Timer0 starts counting in the core's init() just before setup(), so
+  // micros() here is the reset -> ready time (bootloader time excluded)
+  bootReadyUs = micros();
 }
 
 char* bluetoothGetDeviceInfo(char* buffer, size_t bufferSize) {
-  if (buffer == NULL || bufferSize < 50) {
+  if (buffer == NULL || bufferSize < 64) {
     return NULL;
   }
 
-  snprintf(buffer, bufferSize,
-           "Device:%s,FW:%s,Baud:%d",
-           DEVICE_NAME, FIRMWARE_VERSION, BLUETOOTH_BAUD_RATE);
+  snprintf_P(buffer, bufferSize,
+             PSTR("Device:" DEVICE_NAME ",FW:" FIRMWARE_VERSION ",Baud:%d,Boot:%luus"),
+             BLUETOOTH_BAUD_RATE, bootReadyUs);
 
   return buffer;
 }
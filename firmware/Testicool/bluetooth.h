@@ -14,15 +14,76 @@
  *   FROM APP -> DEVICE:
  *     "ON"              - Turn pump ON
  *     "OFF"             - Turn pump OFF
- *     "SPEED:<value>"   - Set pump speed (0-255)
+ *     "SPEED:<value>"   - Set pump speed (0-255; MANUAL mode only)
+ *     "MODE"            - Report the control mode and the PID terms
+ *     "MODE:AUTO"       - Skin temperature PID sets the pump speed
+ *     "MODE:MANUAL"     - Pot / SPEED set the pump speed (default)
+ *     "MODE:ECO"        - Pump pulsed on skin hysteresis at a learned efficient duty
+ *     "ECO"             - Report the ECO pulse phase and learned minimum duty
+ *     "ENERGY"          - Report pump on time, duty cycle, energy and battery life per mode
+ *     "ENERGY:RESET"    - Clear the energy totals
+ *     "TUNE"            - Report the autotuner, the gains in use and settling times
+ *     "TUNE:START"      - Run the relay autotuner (pump must be on); AUTO when done
+ *     "TUNE:STOP"       - Stop the autotuner and keep the previous gains
+ *     "TUNE:RESET"      - Return to the config.h gains and erase the tuned ones
  *     "STATUS"          - Request status update
  *     "TEMP"            - Request temperature reading
+ *     "EST"             - Request estimated temperatures and rates of change
+ *     "INFO"            - Request device info (name, firmware, boot time)
+ *     "TASKS"           - Report scheduler task lateness statistics
+ *     "TASKS:RESET"     - Clear scheduler task statistics
+ *     "TICK"            - Report control tick sample jitter
+ *     "TICK:RESET"      - Clear control tick jitter statistics
+ *     "SUPPLY"          - Report measured Vcc, pump supply and PWM compensation
+ *     "FF"              - Report the water temperature feedforward scale
+ *     "FF:ON" / "FF:OFF" - Scale pump speeds for the water temperature, or not
+ *     "POWER"           - Report time spent in idle sleep
+ *     "POWER:RESET"     - Restart the sleep statistics window
+ *     "BUTTON"          - Report button event queue and latency statistics
+ *     "STALLS"          - Report watchdog resets and the persistent stall log
+ *     "STALLS:CLEAR"    - Clear the stall log
+ *     "RX"              - Report command queue and UART receive statistics
+ *     "FILTER"          - Report raw/filtered ADC readings and noise variance
+ *     "FILTER:BENCH"    - Time the sample filter per reading
+ *     "SENSORS"         - Report every temperature channel (index, name, role, reading)
+ *     "CAL"             - Report thermistor calibration per channel
+ *     "CAL:LOW:<C>"     - Capture the ice bath point at <C> (e.g. CAL:LOW:0.0)
+ *     "CAL:HIGH:<C>"    - Capture the warm bath point at <C> (e.g. CAL:HIGH:40.0)
+ *                         (CAL:WATER:LOW:<C>, CAL:1:HIGH:<C>, ... for one channel,
+ *                         by name or index)
+ *     "CAL:SAVE"        - Solve offset and B from the captured points, store in EEPROM
+ *     "CAL:RESET"       - Return to the config.h calibration and erase the stored one
+ *     "PERF"            - Report per-stage execution times and CPU busy % (PERF_ENABLED)
+ *     "PERF:RESET"      - Clear profiler statistics
  *
  *   FROM DEVICE -> APP:
  *     "OK"              - Command acknowledged
  *     "ERROR:<msg>"     - Error occurred
- *     "STATUS:<data>"   - Status data
- *     "TEMP:<value>"    - Temperature value in Celsius
+ *     "STATUS:<data>"   - Status data (estimated temperatures, temperature sampling rate,
+ *                         measured supply voltage, control mode)
+ *     "TEMP:{...}"      - Water/skin temperature (role aggregates) in Celsius and snapshot age
+ *     "TEMP:<value>"    - Single temperature value in Celsius
+ *     "EST:{...}"       - Estimated temperatures, rates and pump cooling (mC/s)
+ *     "MODE:{...}"      - Control mode, target and PID terms (after MODE)
+ *     "MODE:<mode>"     - Control mode changed (MODE:AUTO / MODE:MANUAL / MODE:ECO command)
+ *     "MANUAL:MODE:<mode>" - Control mode changed by a long button press
+ *     "TUNE:{...}"      - Autotuner progress and result (after TUNE, or when a test ends),
+ *                         followed by "GAINS:{...}" and "SETTLE:{...}" after TUNE
+ *     "Device:<data>"   - Device info
+ *     "TASK:<data>"     - Scheduler statistics, one line per task
+ *     "TICK:<data>"     - Control tick jitter, one line per channel
+ *     "SUPPLY:<data>"   - Supply measurements
+ *     "FF:{...}"        - Water feedforward state and scale
+ *     "ECO:{...}"       - ECO phase, learned minimum and pulse duty, pulse statistics
+ *     "ENERGY:<data>"   - Pump energy accounting, one line per control mode
+ *     "POWER:<data>"    - Idle sleep statistics
+ *     "BUTTON:<data>"   - Button event statistics
+ *     "STALLS:<data>"   - Stall log summary, followed by "STALL:<data>" records
+ *     "RX:<data>"       - Command queue statistics (followed by "UART:<data>")
+ *     "FILTER:<data>"   - Filter state, one line per ADC input (or benchmark result)
+ *     "SENSOR:<data>"   - One line per temperature channel (after SENSORS)
+ *     "CAL:<data>"      - Calibration per channel (after CAL, a capture or CAL:SAVE)
+ *     "PERF:<data>"     - Profiler summary, then one line per stage
  *
  * Team: BME 200/300 Section 301
  */
@@ -32,6 +93,14 @@
 
 #include <Arduino.h>
 
+// Output priority of a line (on the hardware UART every send is queued and
+// never blocks; a line of a higher class goes out before waiting lower ones)
+enum BtPriority {
+  BT_PRIORITY_SAFETY = 0,     // Safety events (OVERHEAT, SAFETY_SHUTOFF, WATCHDOG_RESET)
+  BT_PRIORITY_REPLY = 1,      // Command replies and state change notifications
+  BT_PRIORITY_TELEMETRY = 2   // Periodic status - only the newest unsent line is kept
+};
+
 // ============================================================================
 // BLUETOOTH CONTROL FUNCTIONS
 // ============================================================================
@@ -40,28 +109,40 @@
  * Initialize Bluetooth module
  * Sets up serial communication at configured baud rate
  * Call this function once in setup()
+ * @param commandTask: scheduler task released when a command line is complete
  */
-void bluetoothInit();
+void bluetoothInit(uint8_t commandTask);
 
 /**
  * Process incoming Bluetooth commands
- * Reads and parses commands from Bluetooth serial buffer
- * Call this function regularly in loop()
- * @return true if a command was processed
+ * Parses and executes every complete line in the command queue
+ * Called from the scheduler command task
+ * @return true if at least one command line was handled
  */
 bool bluetoothProcessCommands();
 
 /**
- * Send status update via Bluetooth
+ * Send periodic status update via Bluetooth (telemetry class)
  * Transmits current pump state, speed, runtime, and temperature
+ * The STATUS command sends the same line as a paced reply instead
  */
 void bluetoothSendStatus();
 
 /**
  * Send temperature reading via Bluetooth
- * @param temperature: temperature value in Celsius
+ * @param temperature: temperature in hundredths of a degree Celsius
  */
-void bluetoothSendTemperature(float temperature);
+void bluetoothSendTemperature(int16_t temperature);
+
+/**
+ * Format a temperature for the wire protocol (one decimal place, no float math)
+ * Format: "<degrees>.<tenth>", e.g. 3456 -> "34.6", -50 -> "-0.5"
+ * @param temperature: temperature in hundredths of a degree Celsius
+ * @param buffer: character array to store the string (at least 8 bytes)
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* bluetoothFormatTemperature(int16_t temperature, char* buffer, size_t bufferSize);
 
 /**
  * Send acknowledgment response
@@ -71,14 +152,30 @@ void bluetoothSendOK();
 /**
  * Send error message via Bluetooth
  * @param errorMsg: error message string
+ * @param priority: output class (safety events use BT_PRIORITY_SAFETY)
+ */
+void bluetoothSendError(const char* errorMsg, BtPriority priority = BT_PRIORITY_REPLY);
+
+/**
+ * Send error message stored in flash, e.g. bluetoothSendError(F("BUSY"))
+ * @param errorMsg: error message string in flash (at most 40 characters)
+ * @param priority: output class (safety events use BT_PRIORITY_SAFETY)
  */
-void bluetoothSendError(const char* errorMsg);
+void bluetoothSendError(const __FlashStringHelper* errorMsg, BtPriority priority = BT_PRIORITY_REPLY);
 
 /**
  * Send custom message via Bluetooth
  * @param message: message string to send
+ * @param priority: output class of the line
  */
-void bluetoothSendMessage(const char* message);
+void bluetoothSendMessage(const char* message, BtPriority priority = BT_PRIORITY_REPLY);
+
+/**
+ * Send custom message stored in flash, e.g. bluetoothSendMessage(F("OK"))
+ * @param message: message string in flash (at most 47 characters)
+ * @param priority: output class of the line
+ */
+void bluetoothSendMessage(const __FlashStringHelper* message, BtPriority priority = BT_PRIORITY_REPLY);
 
 /**
  * Check if Bluetooth module is connected
@@ -86,8 +183,22 @@ void bluetoothSendMessage(const char* message);
  */
 bool bluetoothIsConnected();
 
+/**
+ * Check if received bytes are waiting to be processed
+ * Safe to call with interrupts disabled (used as a sleep wake check)
+ * @return true if at least one byte is in the receive buffer
+ */
+bool bluetoothHasInput();
+
+/**
+ * Record the boot-to-ready time
+ * Call this once at the end of setup(), when commands can be handled
+ */
+void bluetoothMarkReady();
+
 /**
  * Get formatted device info string
+ * Format: "Device:<name>,FW:<version>,Baud:<baud>,Boot:<us>us"
  * @param buffer: character array to store info string
  * @param bufferSize: size of buffer array
  * @return pointer to buffer
@@ -0,0 +1,172 @@
+/*
+ * button.cpp
+ * Interrupt-driven manual button implementation for Testicool device
+ *
+ * Queue rules (single producer / single consumer, no locks needed):
+ * - Only the producer writes queueHead, only the consumer writes queueTail
+ * - Both are single bytes, so reads and writes are atomic on the AVR
+ * - A slot is written before queueHead moves past it, and read before
+ *   queueTail moves past it
+ * The producer is the INT0 ISR, or buttonSettle() running with
+ * interrupts disabled, so there is never more than one producer at a time.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "button.h"
+#include "config.h"
+#include "uart.h"
+#include "scheduler.h"
+#include <util/atomic.h>
+
+#define QUEUE_MASK  (BUTTON_EVENT_QUEUE_SIZE - 1)
+
+static_assert((BUTTON_EVENT_QUEUE_SIZE & QUEUE_MASK) == 0 && BUTTON_EVENT_QUEUE_SIZE <= 128,
+              "BUTTON_EVENT_QUEUE_SIZE must be a power of two <= 128");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static ButtonEvent eventQueue[BUTTON_EVENT_QUEUE_SIZE];
+static volatile uint8_t queueHead = 0;   // Next slot to write (producer)
+static volatile uint8_t queueTail = 0;   // Next slot to read (consumer)
+
+// Debounce state (producer side)
+static volatile uint8_t acceptedLevel = HIGH;        // Last reported pin level
+static volatile unsigned long lastEdgeMs = 0;        // millis() of last reported edge
+
+static uint8_t notifyTaskIndex = 0xFF;
+
+// Statistics
+static volatile unsigned long droppedEvents = 0;
+static unsigned long deliveredEvents = 0;
+static unsigned long latencySumUs = 0;
+static unsigned long latencyMaxUs = 0;
+
+// ============================================================================
+// PRIVATE HELPERS (producer side - ISR or interrupts disabled)
+// ============================================================================
+
+static void pushEdge(uint8_t level, unsigned long nowMs) {
+  acceptedLevel = level;
+  lastEdgeMs = nowMs;
+
+  uint8_t next = (queueHead + 1) & QUEUE_MASK;
+  if (next == queueTail) {
+    droppedEvents++;
+    return;
+  }
+
+  eventQueue[queueHead].type = (level == LOW) ? BUTTON_PRESS : BUTTON_RELEASE;
+  eventQueue[queueHead].timeUs = micros();
+  queueHead = next;
+
+  schedulerTrigger(notifyTaskIndex);
+}
+
+// INT0 edge interrupt (both edges)
+static void buttonISR() {
+  unsigned long nowMs = millis();
+  uint8_t level = digitalRead(BUTTON_TOGGLE_PIN);
+
+  // Ignore contact bounce after a reported edge
+  if (nowMs - lastEdgeMs < BUTTON_DEBOUNCE_MS) {
+    return;
+  }
+  // Bounce that ended on the already-reported level
+  if (level == acceptedLevel) {
+    return;
+  }
+
+  pushEdge(level, nowMs);
+}
+
+// ============================================================================
+// BUTTON INITIALIZATION
+// ============================================================================
+
+void buttonInit(uint8_t notifyTask) {
+  pinMode(BUTTON_TOGGLE_PIN, INPUT_PULLUP);   // Internal pull-up resistor
+
+  notifyTaskIndex = notifyTask;
+  acceptedLevel = digitalRead(BUTTON_TOGGLE_PIN);
+  lastEdgeMs = millis();
+
+  attachInterrupt(digitalPinToInterrupt(BUTTON_TOGGLE_PIN), buttonISR, CHANGE);
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(F("[BUTTON] INT0 edge capture enabled"));
+  #endif
+}
+
+// ============================================================================
+// CONSUMER SIDE
+// ============================================================================
+
+bool buttonPopEvent(ButtonEvent* event) {
+  uint8_t tail = queueTail;
+  if (tail == queueHead) {
+    return false;
+  }
+
+  *event = eventQueue[tail];
+  queueTail = (tail + 1) & QUEUE_MASK;
+
+  // Capture -> delivery latency
+  unsigned long latency = micros() - event->timeUs;
+  deliveredEvents++;
+  latencySumUs += latency;
+  if (latency > latencyMaxUs) {
+    latencyMaxUs = latency;
+  }
+
+  return true;
+}
+
+void buttonSettle() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    unsigned long nowMs = millis();
+    if (nowMs - lastEdgeMs >= BUTTON_DEBOUNCE_MS) {
+      uint8_t level = digitalRead(BUTTON_TOGGLE_PIN);
+      if (level != acceptedLevel) {
+        pushEdge(level, nowMs);
+      }
+    }
+  }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void buttonGetStats(ButtonStats* stats) {
+  if (stats == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    stats->dropped = droppedEvents;
+  }
+  stats->events = deliveredEvents;
+  stats->latencyMaxUs = latencyMaxUs;
+  stats->latencyMeanUs = deliveredEvents ? latencySumUs / deliveredEvents : 0;
+}
+
+char* buttonGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  ButtonStats stats;
+  buttonGetStats(&stats);
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("BUTTON:{Events:%lu,Dropped:%lu,Latency:%lu/%luus}"),
+             stats.events,
+             stats.dropped,
+             stats.latencyMeanUs,
+             stats.latencyMaxUs);
+
+  return buffer;
+}
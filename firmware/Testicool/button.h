@@ -0,0 +1,84 @@
+/*
+ * button.h
+ * Interrupt-driven manual button header for Testicool device
+ *
+ * BUTTON_TOGGLE_PIN (D2) is INT0. Every edge is captured by the ISR,
+ * debounced there, timestamped with micros() and pushed into a lock-free
+ * single-producer / single-consumer event queue. The ISR then releases
+ * the button scheduler task, which drains the queue in the main context.
+ *
+ * Debounce is leading-edge: the first edge is reported at once and
+ * further edges are ignored for BUTTON_DEBOUNCE_MS. If the button was
+ * released (or pressed) inside that window, buttonSettle() notices the
+ * mismatch once the window has expired and queues the missing edge, so
+ * even very short taps are never lost.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <Arduino.h>
+
+// Button edge types
+enum ButtonEventType {
+  BUTTON_PRESS = 0,     // Pin went LOW (pressed, pull-up)
+  BUTTON_RELEASE = 1    // Pin went HIGH (released)
+};
+
+// One captured edge
+struct ButtonEvent {
+  uint8_t type;          // ButtonEventType
+  unsigned long timeUs;  // micros() when the edge was captured
+};
+
+// Queue and latency statistics
+struct ButtonStats {
+  unsigned long events;        // Events delivered to the main context
+  unsigned long dropped;       // Events lost because the queue was full
+  unsigned long latencyMaxUs;  // Worst capture -> delivery delay
+  unsigned long latencyMeanUs; // Mean capture -> delivery delay
+};
+
+// ============================================================================
+// BUTTON FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize the button pin and attach the INT0 edge interrupt
+ * Call this function once in setup(), after schedulerInit()
+ * @param notifyTask: scheduler task released when an event is queued
+ */
+void buttonInit(uint8_t notifyTask);
+
+/**
+ * Take the next button event from the queue
+ * Call from the main context only (single consumer)
+ * @param event: structure to fill
+ * @return true if an event was returned, false if the queue is empty
+ */
+bool buttonPopEvent(ButtonEvent* event);
+
+/**
+ * Queue an edge that was swallowed by the debounce window
+ * Call periodically (at least every BUTTON_DEBOUNCE_MS)
+ */
+void buttonSettle();
+
+/**
+ * Get queue and latency statistics
+ * @param stats: structure to fill
+ */
+void buttonGetStats(ButtonStats* stats);
+
+/**
+ * Format queue and latency statistics
+ * Format: "BUTTON:{Events:<n>,Dropped:<n>,Latency:<mean>/<max>us}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* buttonGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // BUTTON_H
@@ -0,0 +1,362 @@
+/*
+ * calibration.cpp
+ * Two-point thermistor calibration implementation for Testicool device
+ *
+ * Temperatures are rescaled in 1/T, kept as 0xFFFFFFFF / (hundredths of a
+ * kelvin): about 5 units per 0.01 K around body temperature, so the
+ * rescale adds no visible error. The B ratio is a 2.14 fixed-point factor.
+ *
+ * Solving: the spread between the two corrected readings grows with the
+ * B ratio, so the ratio that reproduces the spread between the two baths
+ * is found by bisection; the offset then centres both points.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "calibration.h"
+#include "config.h"
+#include "uart.h"
+#include "adcengine.h"
+#include "thermistor.h"
+#include "supply.h"
+#include "eepromwrite.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+#define CAL_RECORD_VERSION  1
+#define KELVIN_CENTI        27315L                 // 0°C in hundredths of a kelvin
+#define RATIO_ONE           16384U                 // B ratio 1.0 in 2.14 fixed point
+#define INVERSE(centiK)     (0xFFFFFFFFUL / (uint32_t)(centiK))
+
+static constexpr uint32_t B_NOMINAL = (uint32_t)(B_COEFFICIENT + 0.5);
+static constexpr uint32_t INV_T0 = INVERSE((uint32_t)((TEMPERATURE_NOMINAL * 100.0) + KELVIN_CENTI + 0.5));
+static constexpr uint32_t INV_MIN = INVERSE(32767L + KELVIN_CENTI);  // Hottest representable result
+static constexpr uint16_t RATIO_MIN = (uint16_t)(B_NOMINAL * RATIO_ONE / CAL_B_MAX);
+static constexpr uint16_t RATIO_MAX = (uint16_t)(B_NOMINAL * RATIO_ONE / CAL_B_MIN);
+
+static_assert(CAL_B_MIN > 0 && CAL_B_MIN < B_NOMINAL && B_NOMINAL < CAL_B_MAX,
+              "B_COEFFICIENT must lie between CAL_B_MIN and CAL_B_MAX");
+static_assert(B_NOMINAL * RATIO_ONE / CAL_B_MIN <= 0xFFFF, "CAL_B_MIN too small for the 2.14 ratio");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// Stored per channel
+struct CalCoefficients {
+  int16_t offset;            // Hundredths of a degree, added after the B correction
+  uint16_t bEffective;       // Effective B coefficient (K)
+};
+
+// EEPROM layout
+struct CalRecord {
+  uint8_t version;
+  uint8_t sensorCount;
+  CalCoefficients sensors[TEMP_CHANNEL_COUNT];
+  uint16_t crc;              // CRC-16 of everything above
+};
+
+static_assert(CAL_EEPROM_ADDR + sizeof(CalRecord) <= TUNE_EEPROM_ADDR,
+              "Calibration record overlaps the autotune record");
+
+// Captured bath
+struct CalCapture {
+  bool valid;
+  int16_t reference;         // True bath temperature
+  int16_t nominal;           // Uncalibrated table temperature at capture
+};
+
+struct CalSensorState {
+  CalCoefficients coefficients;
+  uint16_t ratio;            // B_NOMINAL / bEffective, 2.14 fixed point
+  CalCapture points[2];      // Indexed by CalPoint
+};
+
+#define CHANNEL_OFFSET(name, pin, role, offset)  offset,
+
+static const int16_t defaultOffsets[TEMP_CHANNEL_COUNT] = { TEMP_CHANNELS(CHANNEL_OFFSET) };
+
+static CalSensorState sensors[TEMP_CHANNEL_COUNT];
+static bool fromEeprom = false;
+static CalRecord stored;     // Source of the background EEPROM write (eepromwrite.h)
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static uint16_t recordCrc(const CalRecord* record) {
+  const uint8_t* bytes = (const uint8_t*)record;
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < offsetof(CalRecord, crc); i++) {
+    crc = _crc16_update(crc, bytes[i]);
+  }
+  return crc;
+}
+
+static uint16_t ratioFor(uint16_t bEffective) {
+  return (uint16_t)((B_NOMINAL * RATIO_ONE + bEffective / 2) / bEffective);
+}
+
+static void setCoefficients(uint8_t channel, int16_t offset, uint16_t bEffective) {
+  sensors[channel].coefficients.offset = offset;
+  sensors[channel].coefficients.bEffective = bEffective;
+  sensors[channel].ratio = ratioFor(bEffective);
+}
+
+// Table temperature re-evaluated with another B (ratio = B_NOMINAL / B')
+static int16_t rescale(int16_t nominal, uint16_t ratio) {
+  if (ratio == RATIO_ONE) {
+    return nominal;
+  }
+
+  int32_t kelvin = (int32_t)nominal + KELVIN_CENTI;
+  if (kelvin < 10000) {
+    kelvin = 10000;                       // Far below any table entry
+  }
+
+  int32_t delta = (int32_t)(INVERSE(kelvin) - INV_T0);
+  int32_t inverse = (int32_t)INV_T0 + (int32_t)(((int64_t)delta * ratio) >> 14);
+  if (inverse < (int32_t)INV_MIN) {
+    inverse = INV_MIN;
+  }
+
+  // Rounded 0xFFFFFFFF / inverse
+  int32_t result = (int32_t)((0xFFFFFFFFUL - (uint32_t)inverse / 2) / (uint32_t)inverse) - KELVIN_CENTI;
+  return (int16_t)constrain(result, -32767L, 32767L);
+}
+
+static bool offsetInRange(int32_t offset) {
+  return offset >= -CAL_MAX_OFFSET_C && offset <= CAL_MAX_OFFSET_C;
+}
+
+// Solve one channel's captured points into new coefficients
+static CalResult solve(uint8_t channel, CalCoefficients* result) {
+  const CalSensorState& state = sensors[channel];
+  const CalCapture& low = state.points[CAL_POINT_LOW];
+  const CalCapture& high = state.points[CAL_POINT_HIGH];
+
+  *result = state.coefficients;
+
+  // One point: offset only, B unchanged
+  if (low.valid != high.valid) {
+    const CalCapture& point = low.valid ? low : high;
+    int32_t offset = (int32_t)point.reference - rescale(point.nominal, state.ratio);
+    if (!offsetInRange(offset)) {
+      return CAL_ERR_RANGE;
+    }
+    result->offset = (int16_t)offset;
+    return CAL_OK;
+  }
+
+  int32_t spread = (int32_t)high.reference - low.reference;
+  if (spread < CAL_MIN_SPREAD_C || high.nominal - low.nominal < CAL_MIN_SPREAD_C / 2) {
+    return CAL_ERR_SPREAD;
+  }
+
+  // Corrected spread rises with the ratio: bisect for the bath spread
+  uint16_t lo = RATIO_MIN;
+  uint16_t hi = RATIO_MAX;
+  if (rescale(high.nominal, lo) - rescale(low.nominal, lo) > spread ||
+      rescale(high.nominal, hi) - rescale(low.nominal, hi) < spread) {
+    return CAL_ERR_RANGE;
+  }
+  while (hi - lo > 1) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (rescale(high.nominal, mid) - rescale(low.nominal, mid) < spread) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  int32_t offset = ((int32_t)low.reference - rescale(low.nominal, hi) +
+                    (int32_t)high.reference - rescale(high.nominal, hi)) / 2;
+  if (!offsetInRange(offset)) {
+    return CAL_ERR_RANGE;
+  }
+
+  result->offset = (int16_t)offset;
+  result->bEffective = (uint16_t)((B_NOMINAL * RATIO_ONE + hi / 2) / hi);
+  return CAL_OK;
+}
+
+// Two decimals, e.g. "-0.25"
+static void formatCenti(int16_t value, char* buffer, size_t bufferSize) {
+  uint16_t magnitude = (value < 0) ? (uint16_t)(-(int32_t)value) : (uint16_t)value;
+  snprintf_P(buffer, bufferSize,
+             (value < 0) ? PSTR("-%u.%02u") : PSTR("%u.%02u"),
+             magnitude / 100,
+             magnitude % 100);
+}
+
+static void formatPoint(const CalCapture& point, char* buffer, size_t bufferSize) {
+  if (!point.valid) {
+    strncpy_P(buffer, PSTR("-"), bufferSize - 1);
+    buffer[bufferSize - 1] = '\0';
+    return;
+  }
+  char reference[8];
+  char nominal[8];
+  formatCenti(point.reference, reference, sizeof(reference));
+  formatCenti(point.nominal, nominal, sizeof(nominal));
+  snprintf_P(buffer, bufferSize, PSTR("%s/%sC"), reference, nominal);
+}
+
+// ============================================================================
+// CALIBRATION
+// ============================================================================
+
+// Coefficients of a valid record, or the defaults; captured points are dropped
+static void loadCoefficients(const CalRecord* record) {
+  fromEeprom = (record != NULL);
+
+  for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+    if (record != NULL) {
+      setCoefficients(i, record->sensors[i].offset, record->sensors[i].bEffective);
+    } else {
+      setCoefficients(i, defaultOffsets[i], B_NOMINAL);
+    }
+    sensors[i].points[CAL_POINT_LOW].valid = false;
+    sensors[i].points[CAL_POINT_HIGH].valid = false;
+  }
+}
+
+void calibrationInit() {
+  CalRecord record;
+  eeprom_read_block(&record, (const void*)CAL_EEPROM_ADDR, sizeof(record));
+
+  bool valid = record.version == CAL_RECORD_VERSION &&
+               record.sensorCount == TEMP_CHANNEL_COUNT &&
+               record.crc == recordCrc(&record);
+  loadCoefficients(valid ? &record : NULL);
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(fromEeprom ? F("[CAL] Calibration loaded from EEPROM")
+                                    : F("[CAL] No stored calibration - using defaults"));
+  #endif
+}
+
+int16_t calibrationApply(uint8_t channel, int16_t nominal) {
+  if (channel >= TEMP_CHANNEL_COUNT) {
+    return nominal;
+  }
+  int32_t value = (int32_t)rescale(nominal, sensors[channel].ratio) + sensors[channel].coefficients.offset;
+  return (int16_t)constrain(value, -32767L, 32767L);
+}
+
+CalResult calibrationCapture(uint8_t channel, CalPoint point, int16_t reference) {
+  if (channel >= TEMP_CHANNEL_COUNT) {
+    return CAL_ERR_SENSOR;
+  }
+
+  // An open or shorted probe reads at the ends of the range
+  uint16_t reading = adcEngineGetValue(channel);
+  if (reading < ADC_RESULT_MAX / 50 || reading > ADC_RESULT_MAX - ADC_RESULT_MAX / 50) {
+    return CAL_ERR_SENSOR;
+  }
+
+  CalCapture& capture = sensors[channel].points[point];
+  capture.reference = reference;
+  capture.nominal = thermistorToCentiCelsius(supplyCorrectThermistor(reading), ADC_OVERSAMPLE_BITS);
+  capture.valid = true;
+
+  #if DEBUG_MODE
+    char name[ADC_INPUT_NAME_SIZE];
+    DEBUG_SERIAL.print(F("[CAL] Captured "));
+    DEBUG_SERIAL.print(adcEngineGetInputName(channel, name, sizeof(name)));
+    DEBUG_SERIAL.print(point == CAL_POINT_LOW ? F(" low: ") : F(" high: "));
+    DEBUG_SERIAL.println(capture.nominal);
+  #endif
+
+  return CAL_OK;
+}
+
+CalResult calibrationSave() {
+  CalRecord record;
+  bool anyPoints = false;
+
+  // Solve everything first, so a bad channel leaves all of them unchanged
+  for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+    record.sensors[i] = sensors[i].coefficients;
+    if (sensors[i].points[CAL_POINT_LOW].valid || sensors[i].points[CAL_POINT_HIGH].valid) {
+      CalResult result = solve(i, &record.sensors[i]);
+      if (result != CAL_OK) {
+        return result;
+      }
+      anyPoints = true;
+    }
+  }
+  if (!anyPoints) {
+    return CAL_ERR_NO_POINTS;
+  }
+
+  for (uint8_t i = 0; i < TEMP_CHANNEL_COUNT; i++) {
+    setCoefficients(i, record.sensors[i].offset, record.sensors[i].bEffective);
+    sensors[i].points[CAL_POINT_LOW].valid = false;
+    sensors[i].points[CAL_POINT_HIGH].valid = false;
+  }
+
+  record.version = CAL_RECORD_VERSION;
+  record.sensorCount = TEMP_CHANNEL_COUNT;
+  record.crc = recordCrc(&record);
+
+  // ~3.4 ms per changed byte - written in the background, not in the CMD task
+  stored = record;
+  eepromWriteStart(EEPROM_RECORD_CALIBRATION, CAL_EEPROM_ADDR, &stored, sizeof(stored));
+  fromEeprom = true;
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(F("[CAL] Calibration saved"));
+  #endif
+
+  return CAL_OK;
+}
+
+void calibrationReset() {
+  // A version byte that never matches invalidates the record (and
+  // replaces a save still being written)
+  stored.version = 0xFF;
+  eepromWriteStart(EEPROM_RECORD_CALIBRATION, CAL_EEPROM_ADDR, &stored.version, 1);
+  loadCoefficients(NULL);
+}
+
+const __FlashStringHelper* calibrationGetResultString(CalResult result) {
+  switch (result) {
+    case CAL_OK:            return F("OK");
+    case CAL_ERR_SENSOR:    return F("CAL_SENSOR");
+    case CAL_ERR_NO_POINTS: return F("CAL_NO_POINTS");
+    case CAL_ERR_SPREAD:    return F("CAL_SPREAD");
+    case CAL_ERR_RANGE:     return F("CAL_RANGE");
+    default:                return F("CAL_FAILED");
+  }
+}
+
+char* calibrationGetStatusString(uint8_t channel, char* buffer, size_t bufferSize) {
+  if (channel >= TEMP_CHANNEL_COUNT || buffer == NULL || bufferSize < 96) {
+    return NULL;
+  }
+
+  const CalSensorState& state = sensors[channel];
+  char name[ADC_INPUT_NAME_SIZE];
+  char offset[8];
+  char low[18];
+  char high[18];
+  adcEngineGetInputName(channel, name, sizeof(name));
+  formatCenti(state.coefficients.offset, offset, sizeof(offset));
+  formatPoint(state.points[CAL_POINT_LOW], low, sizeof(low));
+  formatPoint(state.points[CAL_POINT_HIGH], high, sizeof(high));
+
+  char source[8];
+  strcpy_P(source, fromEeprom ? PSTR("EEPROM") : PSTR("DEFAULT"));
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("CAL:%s,Offset:%sC,B:%uK,Low:%s,High:%s,Source:%s"),
+             name,
+             offset,
+             state.coefficients.bEffective,
+             low,
+             high,
+             source);
+
+  return buffer;
+}
@@ -0,0 +1,114 @@
+/*
+ * calibration.h
+ * Two-point thermistor calibration header for Testicool device
+ *
+ * Each temperature channel (TEMP_CHANNELS in config.h) gets an offset and
+ * an effective B coefficient.
+ * They are solved on the device from two baths of known temperature
+ * (ice water and a warm bath) and kept in EEPROM with a CRC, so a unit
+ * can be recalibrated over Bluetooth without a toolchain:
+ *
+ *   CAL:LOW:0.0      all probes in ice water, capture the low point
+ *   CAL:HIGH:40.0    probes in a 40.0°C bath, capture the high point
+ *   CAL:SAVE         solve, apply and store
+ *
+ * The conversion table (thermistor.h) stays in flash; a 1024-entry RAM copy
+ * per channel would not fit in the Nano's 2 KB. The calibration is applied
+ * to the table's result instead. With the B equation
+ *
+ *   1/T = 1/T0 + ln(R/R0) / B
+ *
+ * the same resistance under another B gives
+ *
+ *   1/T' = 1/T0 + (B_COEFFICIENT / B') * (1/T - 1/T0)
+ *
+ * so no log() is needed - one 32-bit division per conversion. At boot
+ * only the small record is read and checked; nothing is rebuilt.
+ *
+ * Without a valid record (or after the channel table changed) the channels
+ * use B_COEFFICIENT and the default offsets of their TEMP_CHANNELS rows.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+
+// Calibration bath
+enum CalPoint {
+  CAL_POINT_LOW = 0,         // Ice water
+  CAL_POINT_HIGH             // Warm bath
+};
+
+// Outcome of a capture or save
+enum CalResult {
+  CAL_OK = 0,
+  CAL_ERR_SENSOR,            // Reading at the end of the ADC range (open or shorted probe)
+  CAL_ERR_NO_POINTS,         // Nothing captured since the last save
+  CAL_ERR_SPREAD,            // Low and high bath closer than CAL_MIN_SPREAD_C
+  CAL_ERR_RANGE              // Solved B or offset outside the config.h limits
+};
+
+// ============================================================================
+// CALIBRATION FUNCTIONS
+// ============================================================================
+
+/**
+ * Load the stored calibration, or the config.h defaults if the EEPROM
+ * record is missing or fails its CRC
+ * Call once in setup(), before sensorsInit()
+ */
+void calibrationInit();
+
+/**
+ * Apply a channel's calibration to an uncalibrated table temperature
+ * @param channel: temperature channel index
+ * @param nominal: thermistorToCentiCelsius() result (hundredths of a degree)
+ * @return calibrated temperature (hundredths of a degree)
+ */
+int16_t calibrationApply(uint8_t channel, int16_t nominal);
+
+/**
+ * Capture a calibration point from the channel's current reading
+ * Wait for the reading to settle in the bath first (see FILTER / SENSORS)
+ * @param channel: temperature channel index
+ * @param point: CalPoint
+ * @param reference: true bath temperature (hundredths of a degree)
+ * @return CAL_OK or CAL_ERR_SENSOR
+ */
+CalResult calibrationCapture(uint8_t channel, CalPoint point, int16_t reference);
+
+/**
+ * Solve every channel with captured points, apply the result and store it
+ * Two points give offset and B; a single point only corrects the offset.
+ * Nothing changes unless every captured channel solves.
+ * @return CAL_OK or the first error
+ */
+CalResult calibrationSave();
+
+/**
+ * Return to the config.h defaults and invalidate the stored record
+ */
+void calibrationReset();
+
+/**
+ * Get the protocol name of a result
+ * @param result: CalResult
+ * @return error code string in flash, e.g. F("CAL_SPREAD")
+ */
+const __FlashStringHelper* calibrationGetResultString(CalResult result);
+
+/**
+ * Format one channel's calibration and captured points
+ * Format: "CAL:<name>,Offset:<C>,B:<K>,Low:<ref>/<measured>C,High:...,Source:<DEFAULT|EEPROM>"
+ * (points show "-" until captured)
+ * @param channel: temperature channel index
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* calibrationGetStatusString(uint8_t channel, char* buffer, size_t bufferSize);
+
+#endif // CALIBRATION_H
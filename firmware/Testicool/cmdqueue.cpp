@@ -0,0 +1,180 @@
+/*
+ * cmdqueue.cpp
+ * Bluetooth command line assembler implementation for Testicool device
+ *
+ * Slot ring rules (single producer / single consumer, same as button.cpp):
+ * - slotHead and slotTail are free-running byte counters; head - tail is
+ *   the number of complete lines
+ * - The producer assembles into slot (slotHead & mask) and only moves
+ *   slotHead once the line is complete
+ * - The consumer reads slot (slotTail & mask) and moves slotTail after it
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "cmdqueue.h"
+#include "config.h"
+#include "scheduler.h"
+#include <util/atomic.h>
+
+#define SLOT_MASK  (CMD_SLOT_COUNT - 1)
+
+static_assert((CMD_SLOT_COUNT & SLOT_MASK) == 0 && CMD_SLOT_COUNT <= 128,
+              "CMD_SLOT_COUNT must be a power of two <= 128");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct CmdSlot {
+  char text[CMD_SLOT_SIZE];
+  bool tooLong;
+};
+
+static CmdSlot slots[CMD_SLOT_COUNT];
+static volatile uint8_t slotHead = 0;    // Lines completed (producer)
+static volatile uint8_t slotTail = 0;    // Lines consumed (consumer)
+
+// Producer-only assembly state
+static uint8_t fillLength = 0;           // Characters received for the current line
+static bool discarding = false;          // No free slot at line start - drop until terminator
+
+static uint8_t notifyTaskIndex = SCHEDULER_NO_TASK;
+
+// Statistics (written by the producer)
+static volatile unsigned long linesQueued = 0;
+static volatile uint16_t linesDropped = 0;
+static volatile uint16_t linesTooLong = 0;
+static volatile uint8_t maxDepth = 0;
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void cmdQueueInit(uint8_t notifyTask) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    notifyTaskIndex = notifyTask;
+    slotHead = 0;
+    slotTail = 0;
+    fillLength = 0;
+    discarding = false;
+  }
+}
+
+// ============================================================================
+// PRODUCER SIDE (RX interrupt)
+// ============================================================================
+
+void cmdQueueReceive(char c) {
+  if (c == '\n' || c == '\r') {
+    if (discarding) {
+      discarding = false;
+      if (linesDropped < 0xFFFF) {
+        linesDropped++;
+      }
+      return;
+    }
+    if (fillLength == 0) {
+      return;  // Empty line (second half of "\r\n")
+    }
+
+    CmdSlot& slot = slots[slotHead & SLOT_MASK];
+    slot.tooLong = (fillLength >= CMD_SLOT_SIZE);
+    slot.text[slot.tooLong ? CMD_SLOT_SIZE - 1 : fillLength] = '\0';
+    if (slot.tooLong && linesTooLong < 0xFFFF) {
+      linesTooLong++;
+    }
+
+    slotHead++;
+    fillLength = 0;
+    linesQueued++;
+
+    uint8_t depth = slotHead - slotTail;
+    if (depth > maxDepth) {
+      maxDepth = depth;
+    }
+
+    schedulerTrigger(notifyTaskIndex);
+    return;
+  }
+
+  // First character of a line claims the next slot
+  if (fillLength == 0 && !discarding) {
+    if ((uint8_t)(slotHead - slotTail) >= CMD_SLOT_COUNT) {
+      discarding = true;
+    }
+  }
+  if (discarding) {
+    return;
+  }
+
+  if (fillLength < CMD_SLOT_SIZE - 1) {
+    slots[slotHead & SLOT_MASK].text[fillLength] = c;
+  }
+  if (fillLength < 0xFF) {
+    fillLength++;
+  }
+}
+
+// ============================================================================
+// CONSUMER SIDE
+// ============================================================================
+
+bool cmdQueueHasLine() {
+  return slotHead != slotTail;
+}
+
+const char* cmdQueuePeek(bool* tooLong) {
+  uint8_t tail = slotTail;
+  if (tail == slotHead) {
+    return NULL;
+  }
+
+  const CmdSlot& slot = slots[tail & SLOT_MASK];
+  if (tooLong != NULL) {
+    *tooLong = slot.tooLong;
+  }
+  return slot.text;
+}
+
+void cmdQueuePop() {
+  if (slotTail != slotHead) {
+    slotTail++;
+  }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void cmdQueueGetStats(CmdQueueStats* stats) {
+  if (stats == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    stats->lines = linesQueued;
+    stats->dropped = linesDropped;
+    stats->tooLong = linesTooLong;
+    stats->maxDepth = maxDepth;
+  }
+}
+
+char* cmdQueueGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  CmdQueueStats stats;
+  cmdQueueGetStats(&stats);
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("RX:{Lines:%lu,Dropped:%u,TooLong:%u,MaxDepth:%u/%u}"),
+             stats.lines,
+             stats.dropped,
+             stats.tooLong,
+             stats.maxDepth,
+             CMD_SLOT_COUNT);
+
+  return buffer;
+}
@@ -0,0 +1,85 @@
+/*
+ * cmdqueue.h
+ * Bluetooth command line assembler header for Testicool device
+ *
+ * Received bytes are assembled into complete command lines directly in a
+ * small pool of fixed-size slots (CMD_SLOT_COUNT x CMD_SLOT_SIZE). With
+ * the hardware UART the producer is the USART RX interrupt, so nothing
+ * depends on how often loop() polls; the command task drains every
+ * complete line in one pass.
+ *
+ * Lines end with '\n' or '\r'; empty lines are ignored. A line that does
+ * not fit a slot is kept truncated and flagged (answered with
+ * CMD_TOO_LONG). A line arriving while all slots are full is dropped and
+ * counted.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef CMDQUEUE_H
+#define CMDQUEUE_H
+
+#include <Arduino.h>
+
+// Line assembler statistics
+struct CmdQueueStats {
+  unsigned long lines;       // Complete lines queued
+  uint16_t dropped;          // Lines lost because every slot was full
+  uint16_t tooLong;          // Lines longer than a slot (truncated)
+  uint8_t maxDepth;          // Most slots in use at once
+};
+
+// ============================================================================
+// COMMAND QUEUE FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize the slot pool
+ * @param notifyTask: scheduler task released when a line is complete
+ */
+void cmdQueueInit(uint8_t notifyTask);
+
+/**
+ * Feed one received byte to the line assembler (producer side)
+ * Called from the USART RX interrupt, or from the main context when
+ * the Bluetooth module is on SoftwareSerial
+ * @param c: received character
+ */
+void cmdQueueReceive(char c);
+
+/**
+ * Check whether a complete line is waiting
+ * Safe to call with interrupts disabled (used as a sleep wake check)
+ * @return true if at least one line is queued
+ */
+bool cmdQueueHasLine();
+
+/**
+ * Get the oldest complete line without removing it
+ * The text stays valid until cmdQueuePop()
+ * @param tooLong: set to true if the line was truncated
+ * @return null-terminated line, NULL if the queue is empty
+ */
+const char* cmdQueuePeek(bool* tooLong);
+
+/**
+ * Release the oldest line so its slot can be reused
+ */
+void cmdQueuePop();
+
+/**
+ * Get line assembler statistics
+ * @param stats: structure to fill
+ */
+void cmdQueueGetStats(CmdQueueStats* stats);
+
+/**
+ * Format line assembler statistics
+ * Format: "RX:{Lines:<n>,Dropped:<n>,TooLong:<n>,MaxDepth:<n>/<slots>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* cmdQueueGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // CMDQUEUE_H
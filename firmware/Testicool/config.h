@@ -12,27 +12,57 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+
 // ============================================================================
 // HARDWARE PIN DEFINITIONS
 // ============================================================================
 
 // Pump Control Pins
-#define PUMP_PWM_PIN        9      // PWM output to control pump speed (must be PWM-capable pin)
+#define PUMP_PWM_PIN        9      // PWM output to control pump speed (fixed: Timer1 OC1A, see pumppwm.h)
 #define PUMP_ENABLE_PIN     8      // Digital pin to enable/disable pump
 #define PUMP_DIRECTION_PIN  7      // Optional: for bidirectional pumps (not used in single-direction setup)
 
 // Manual Control Button (single momentary tactile switch on bottle lid)
 #define BUTTON_TOGGLE_PIN   2      // Toggle button - press to turn ON/OFF (interrupt-capable pin)
 #define BUTTON_DEBOUNCE_MS  50     // Button debounce delay in milliseconds
+#define BUTTON_EVENT_QUEUE_SIZE 8  // ISR -> main event queue depth (power of two)
+#define BUTTON_LONG_PRESS_MS 1500  // Holding this long also switches MANUAL / AUTO (every press toggles the pump at once)
 
 // Manual Speed Control (rotary potentiometer on bottle lid)
 #define SPEED_POT_PIN       A2     // Potentiometer for manual speed control (0-5V = 0-255 PWM)
 #define SPEED_READ_INTERVAL_MS  100  // Read potentiometer every 100ms
 
-// Temperature Sensors (dual thermistor setup)
+// Temperature Sensors (thermistor channels)
 #define TEMP_SENSOR_WATER_PIN  A0  // Water temperature sensor (thermistor in reservoir)
 #define TEMP_SENSOR_SKIN_PIN   A1  // Skin temperature sensor (thermistor on user)
 
+// Channel table, one row per thermistor: TEMP_CHANNEL(name, analog pin, role, default calibration offset)
+// Names are upper case, at most 7 characters (CAL:<name>:LOW:... matches them against the upper-cased command).
+// Roles: SENSOR_ROLE_WATER (averaged into the water temperature) and
+// SENSOR_ROLE_SKIN (the hottest one is the skin temperature); at least one of each.
+// The ADC engine, filters, calibration, snapshot and SENSORS report all loop
+// over this table, so another probe is another row.
+// Free analog pins are A3-A7, less PUMP_SUPPLY_PIN. The RAM each channel costs is listed in sensors.h.
+// Example: inlet/outlet water and two skin points
+//   TEMP_CHANNEL("INLET",  A0, SENSOR_ROLE_WATER, 0)  TEMP_CHANNEL("OUTLET", A3, SENSOR_ROLE_WATER, 0)
+//   TEMP_CHANNEL("SKIN_L", A1, SENSOR_ROLE_SKIN,  0)  TEMP_CHANNEL("SKIN_R", A6, SENSOR_ROLE_SKIN,  0)
+#define TEMP_CHANNELS(TEMP_CHANNEL) \
+  TEMP_CHANNEL("WATER", TEMP_SENSOR_WATER_PIN, SENSOR_ROLE_WATER, WATER_TEMP_OFFSET) \
+  TEMP_CHANNEL("SKIN",  TEMP_SENSOR_SKIN_PIN,  SENSOR_ROLE_SKIN,  SKIN_TEMP_OFFSET)
+
+#define TEMP_CHANNEL_ONE(name, pin, role, offset)  + 1
+#define TEMP_CHANNEL_COUNT  (0 TEMP_CHANNELS(TEMP_CHANNEL_ONE))
+
+// NTC 10K thermistor parameters (the ADC -> temperature table is built from these at compile time, see thermistor.h)
+// WIRING: Thermistor to +5V, series resistor to GND
+#define THERMISTOR_NOMINAL  10000.0  // Resistance at 25°C (10kΩ)
+#define TEMPERATURE_NOMINAL 25.0     // Temperature for nominal resistance (25°C)
+#define B_COEFFICIENT       3950.0   // Beta coefficient for NTC thermistor
+#define SERIES_RESISTOR     10000.0  // Value of series resistor (10kΩ)
+// Optional manufacturer R-T curve used instead of the B equation: { {°C, ohms}, ... }, rising temperature
+// #define THERMISTOR_RT_TABLE { {-20, 97070}, {0, 32650}, {25, 10000}, {50, 3603}, {75, 1481}, {100, 678} }
+
 // LED Status Indicators (optional)
 #define LED_POWER_PIN       12     // Power/status LED
 #define LED_BLUETOOTH_PIN   13     // Bluetooth connection LED (Arduino Nano onboard LED)
@@ -45,6 +75,23 @@
 #define PUMP_MAX_SPEED      255    // Maximum PWM value (0-255, full speed)
 #define PUMP_DEFAULT_SPEED  180    // Default operating speed (70% power for quieter operation)
 
+// Timer1 pump PWM (see pumppwm.h)
+#define PUMP_PWM_HZ         20000  // Above hearing; 16 MHz / 20 kHz = 800 duty steps
+#define PUMP_HIRES_MAX      1023   // Full scale of pumpSetSpeedHiRes() (10-bit, about 4 levels per speed unit)
+
+// Speed (0-255) to high-resolution level (0-PUMP_HIRES_MAX) and back, rounded
+#define SPEED_TO_HIRES(speed)  ((uint16_t)(((uint32_t)(speed) * PUMP_HIRES_MAX + 127) / 255))
+#define HIRES_TO_SPEED(level)  ((uint8_t)(((uint32_t)(level) * 255 + PUMP_HIRES_MAX / 2) / PUMP_HIRES_MAX))
+
+// Supply voltage compensation (see supply.h): with a divider from the pump
+// supply to PUMP_SUPPLY_PIN, PWM duty is scaled by nominal / measured supply
+// so the pump gets the same average voltage (and power) as the pack runs down
+#define PUMP_SUPPLY_SENSE_ENABLED  false  // Divider fitted (e.g. 30k top / 10k bottom)
+#define PUMP_SUPPLY_PIN     A6     // Analog-only pin on the Nano
+#define PUMP_SUPPLY_DIVIDER 4.0    // (R top + R bottom) / R bottom; 12.6 V full pack -> 3.15 V
+#define PUMP_SUPPLY_NOMINAL_MV  12000  // Supply the pump speeds are meant for (duty unchanged here)
+#define PUMP_SUPPLY_MIN_MV      6000   // Below this: pump supply off or divider missing, no compensation
+
 // Flow rate assumptions:
 // Typical mini DC pumps: 1-3 L/min at 12V
 // For 946mL reservoir with tubing loop ~1-2 meters, circulation time ~30-60 seconds
@@ -54,10 +101,30 @@
 // ============================================================================
 
 #define MAX_RUN_TIME_MS     1800000L  // 30 minutes max continuous operation (30 * 60 * 1000)
-#define OVERHEAT_TEMP_C     40.0      // Simulated overtemperature cutoff (°C)
-#define UNDERCOOL_TEMP_C    30.0      // Simulated under-temperature cutoff (°C)
-#define TARGET_TEMP_MIN_C   34.0      // Target scrotal temperature minimum (°C)
-#define TARGET_TEMP_MAX_C   35.0      // Target scrotal temperature maximum (°C)
+
+// Temperatures are carried as int16 hundredths of a degree Celsius
+// (centi-degrees, 34.50°C = 3450) from the ADC table to the wire protocol.
+// CENTI_C() converts at compile time, so no floating point reaches the firmware.
+#define CENTI_C(celsius)    ((int16_t)((celsius) * 100 + ((celsius) < 0 ? -0.5 : 0.5)))
+
+constexpr int16_t OVERHEAT_TEMP_C   = CENTI_C(40.0);   // Simulated overtemperature cutoff
+constexpr int16_t UNDERCOOL_TEMP_C  = CENTI_C(30.0);   // Simulated under-temperature cutoff
+constexpr int16_t TARGET_TEMP_MIN_C = CENTI_C(34.0);   // Target scrotal temperature minimum (AUTO mode holds the middle)
+constexpr int16_t TARGET_TEMP_MAX_C = CENTI_C(35.0);   // Target scrotal temperature maximum
+constexpr int16_t WATER_WARM_TEMP_C = CENTI_C(30.0);   // Water too warm to cool effectively (debug warning)
+
+// Thermistor calibration offsets of the default channel table, used until a
+// two-point calibration is stored over Bluetooth (CAL commands, see calibration.h)
+constexpr int16_t WATER_TEMP_OFFSET = CENTI_C(0.0);
+constexpr int16_t SKIN_TEMP_OFFSET  = CENTI_C(0.0);
+
+// Two-point calibration limits and storage
+#define CAL_EEPROM_ADDR     0      // EEPROM address of the calibration record (CRC-protected)
+#define CAL_B_MIN           2000   // Solved effective B coefficient must be within these (K)
+#define CAL_B_MAX           6000
+constexpr int16_t CAL_MIN_SPREAD_C = CENTI_C(10.0);   // Low and high bath at least this far apart
+constexpr int16_t CAL_MAX_OFFSET_C = CENTI_C(5.0);    // Largest offset a calibration may apply
+#define TUNE_EEPROM_ADDR    64     // EEPROM address of the autotuned gains (after the calibration record)
 
 // ============================================================================
 // BLUETOOTH CONFIGURATION
@@ -79,6 +146,15 @@
 #define BLUETOOTH_BAUD_RATE 9600   // Standard baud rate for KS-03/JDY-31/HC-05/HC-06
                                     // KS-03 and JDY-31 default to 9600 baud
 
+// Receive line assembly (interrupt-driven, see cmdqueue.h)
+#define CMD_SLOT_COUNT      4      // Complete command lines buffered (power of two)
+#define CMD_SLOT_SIZE       32     // Longest command + terminator; longer lines get CMD_TOO_LONG
+// Output queue per priority class (powers of two <= 128, see uart.h)
+#define UART_TX_SAFETY_SIZE     64   // Safety events
+#define UART_TX_REPLY_SIZE      128  // Command replies (STATUS and multi-line reports are paced to fit)
+#define UART_TX_TELEMETRY_SIZE  128  // Longest periodic status line + line ending (x2, double-buffered)
+#define UART_TX_DEBUG_SIZE      64   // DEBUG_SERIAL prints (only allocated with DEBUG_MODE)
+
 // Debug echo: Set to true to echo all Bluetooth traffic to Serial Monitor
 #define BT_DEBUG_ECHO       true   // Set false in production to reduce Serial overhead
 
@@ -91,8 +167,97 @@
 // ============================================================================
 
 #define STATUS_UPDATE_INTERVAL_MS  5000    // Send status updates every 5 seconds
-#define TEMP_READ_INTERVAL_MS      2000    // Read temperature every 2 seconds
-#define LOOP_DELAY_MS              100     // Main loop delay for non-blocking operation
+#define TEMP_READ_INTERVAL_MS      2000    // Read temperature every 2 seconds (normal adaptive rate)
+
+// Adaptive temperature sampling (see samplerate.h): the TEMP task runs at
+// the fastest rate any condition asks for and slows down only after a hold
+#define TEMP_RATE_FAST_MS          100     // Skin near OVERHEAT_TEMP_C or heading for it (10 Hz)
+#define TEMP_RATE_ACTIVE_MS        500     // Pump just switched or temperature moving fast (2 Hz)
+#define TEMP_RATE_IDLE_MS          5000    // Pump off and temperatures steady (0.2 Hz)
+#define TEMP_RATE_NEAR_MARGIN_C    1.0     // "Near" = within this many degrees below the threshold...
+#define TEMP_RATE_HORIZON_S        30      // ...or projected to cross it within this time
+#define TEMP_RATE_FAST_SLOPE       20      // |dT/dt| that counts as moving fast (thousandths of a degree per second)
+#define TEMP_RATE_STEADY_SLOPE     3       // |dT/dt| below this counts as steady
+#define TEMP_RATE_BOOST_MS         20000   // Active rate after a pump start, stop or speed change
+#define TEMP_RATE_SPEED_STEP       16      // Commanded speed change (0-255) that counts as a speed change
+#define TEMP_RATE_IDLE_AFTER_MS    120000L // Steady this long with the pump off before the idle rate
+#define TEMP_RATE_HOLD_MS          10000   // A faster rate is kept at least this long
+
+// Interrupt-driven ADC engine (see adcengine.h)
+#define ADC_OVERSAMPLE_BITS        2       // 4^n conversions per reading for n extra bits (2 = 12-bit, 3 = 13-bit, max 3)
+#define FILTER_MEDIAN_SIZE         5       // Despiker window in readings: 5 or 7 (1 = off); rejects spikes up to 2 / 3 readings long
+#define FILTER_EMA_SHIFT           4       // Moving average weight 1/2^n per reading (4: ~16 readings = 130 ms; 0 = off)
+#define ADC_ON_DEMAND_MIN_MS       500     // Every tick channel this slow or slower: the ADC only runs in a burst before each sample
+#define ADC_BURST_CYCLES           16      // Engine cycles per burst: 16 readings per input, one EMA time constant at FILTER_EMA_SHIFT 4
+
+// Supply measurement (supply.h): AVcc against the internal bandgap, every
+// ADC engine cycle, converted to millivolts by the SAFETY task
+#define BANDGAP_MV                 1100    // Bandgap voltage; +/-10% between chips - trim to Vcc measured with a meter
+#define BANDGAP_SETTLE_CONVERSIONS 10      // Conversions discarded after switching to the bandgap (~1 ms)
+#define THERMISTOR_RATIOMETRIC     true    // Dividers fed from AVcc (Nano 5V pin): Vcc cancels out of the reading
+#define THERMISTOR_SUPPLY_MV       5000    // Divider supply when not ratiometric (e.g. a separate regulator)
+
+// Thermal state estimator (see estimator.h); steps on every POT sample:
+// every ESTIMATOR_PERIOD_MS while the pump runs, at the temperature rate while it is off
+#define ESTIMATOR_PERIOD_MS        SPEED_READ_INTERVAL_MS
+#define ESTIMATOR_SENSOR_NOISE_C   0.05    // Snapshot temperature noise, 1 sigma (C)
+#define ESTIMATOR_ACCEL_NOISE_C    0.01    // How fast the rate of change may change, 1 sigma (C/s^2)
+#define ESTIMATOR_COOLING_PER_S    0.005   // Share of the skin-water difference the pump removes per second at full speed
+
+// Skin temperature PID for AUTO mode (see thermostat.h); gains are in pump
+// duty (0-255) per unit of skin temperature error
+#define THERMOSTAT_PERIOD_MS       1000    // Controller step (multiple of ESTIMATOR_PERIOD_MS)
+#define THERMOSTAT_KP              60.0    // Duty per degree above the target
+#define THERMOSTAT_KI              1.0     // Duty per degree-second (integral time 60 s)
+#define THERMOSTAT_KD              300.0   // Duty per degree/second of skin rise (derivative time 5 s)
+#define THERMOSTAT_MIN_DUTY        40      // Lower outputs stop the pump instead (it stalls below this)
+#define THERMOSTAT_SETTLE_HOLD_MS  60000L  // Settled once within half the band of the target this long
+
+// Relay autotuner for the PID gains (see autotune.h, TUNE commands)
+#define AUTOTUNE_DUTY_LOW          0       // Relay levels the pump is switched between
+#define AUTOTUNE_DUTY_HIGH         200
+#define AUTOTUNE_HYSTERESIS_C      0.05    // Switch this far past the target (above the estimate's noise)
+#define AUTOTUNE_CYCLES            2       // Oscillation cycles averaged (after one skipped)
+#define AUTOTUNE_TIMEOUT_MS        600000L // Give up after 10 minutes
+
+// Water temperature feedforward on the MANUAL speed (see feedforward.h)
+#define FEEDFORWARD_ENABLED        true    // false = speeds go to the pump unscaled (FF:ON / FF:OFF at runtime)
+#define FEEDFORWARD_REF_WATER_C    15.0    // Water temperature at which a speed passes unchanged
+#define FEEDFORWARD_MIN_PCT        50      // Scale limits: coldest water ...
+#define FEEDFORWARD_MAX_PCT        250     // ... and warmest
+
+// ECO mode: pump pulsed on skin hysteresis at a learned efficient duty (see eco.h)
+#define ECO_ON_C                   34.7    // Pulse starts when the skin reaches this ...
+#define ECO_OFF_C                  34.3    // ... and stops when it is back down here (both inside the target band)
+#define ECO_START_DUTY             THERMOSTAT_MIN_DUTY  // Minimum effective duty before anything is learned
+#define ECO_LEARN_STEP             4       // Each probe runs this far below the learned minimum
+#define ECO_PROBE_MS               20000L  // Probe length (covers the loop's transport delay)
+#define ECO_FLOW_RATE_MC_S         5       // Skin warming this much slower (m°C/s) than when stopped shows flow
+#define ECO_PULSE_PCT              200     // Pulse duty as % of the minimum (200 = most cooling per joule)
+#define ECO_BOOST_STEP             16      // Added to a pulse each ECO_PROBE_MS it is not cooling the skin
+
+// Pump energy accounting (see energy.h, ENERGY command)
+#define PUMP_FULL_POWER_MW         6000    // Pump power at full duty and PUMP_SUPPLY_NOMINAL_MV (measure it)
+#define BATTERY_CAPACITY_MWH       24000   // Pump battery, for the life estimate (12 V x 2000 mAh)
+
+// Fixed-rate control tick (Timer2 compare-match, see controltick.h)
+// Temperature and potentiometer sampling run on this tick, so
+// TEMP_READ_INTERVAL_MS and SPEED_READ_INTERVAL_MS must be multiples of its period
+#define CONTROL_TICK_HZ            250     // 4 ms tick (16 MHz / 256 / 250)
+
+// Cooperative scheduler task periods (see scheduler.h and the task table in Testicool.ino)
+#define BUTTON_SETTLE_INTERVAL_MS  BUTTON_DEBOUNCE_MS  // Debounce settle check (edges themselves arrive via INT0)
+#define COMMAND_POLL_INTERVAL_MS   10      // Drain Bluetooth RX buffer (~10 bytes arrive per 10 ms at 9600 baud)
+#define SAFETY_CHECK_INTERVAL_MS   1000    // Pump runtime safety check
+#define LED_UPDATE_INTERVAL_MS     25      // LED pattern engine step (pattern timing resolution)
+
+// Tickless idle (see power.h): sleep in IDLE mode until the next task deadline
+#define IDLE_SLEEP_ENABLED         true    // false = spin between tasks (for A/B battery comparison)
+#define IDLE_MIN_SLEEP_US          200     // Do not sleep for gaps shorter than this
+
+// Stall detection
+#define WATCHDOG_ENABLED           true    // Hardware watchdog (timeout derived from the task table)
+#define STALL_LOG_SIZE             8       // Stall records kept across resets (.noinit RAM)
 
 // ============================================================================
 // SERIAL DEBUG CONFIGURATION
@@ -100,14 +265,15 @@
 
 #define DEBUG_MODE          false   // Set to false to disable debug serial prints
 #define SERIAL_BAUD_RATE    9600    // Serial monitor baud rate (same as Bluetooth for simplicity)
+#define PERF_ENABLED        true    // Per-stage execution-time profiler (PERF command); false compiles it out
 
 // ============================================================================
 // SIMULATED SENSOR VALUES (for prototype testing without hardware sensors)
 // ============================================================================
 
 #define SIMULATE_TEMPERATURE     false  // Set to true to use simulated temp readings
-#define SIMULATED_WATER_TEMP_C   12.0   // Simulated water temperature in Celsius (cold)
-#define SIMULATED_SKIN_TEMP_C    34.0   // Simulated skin temperature in Celsius (body temp)
+constexpr int16_t SIMULATED_WATER_TEMP_C = CENTI_C(12.0);   // Simulated water temperature (cold)
+constexpr int16_t SIMULATED_SKIN_TEMP_C  = CENTI_C(34.0);   // Simulated skin temperature (body temp)
 
 // ============================================================================
 // VERSION INFORMATION
@@ -0,0 +1,298 @@
+/*
+ * controltick.cpp
+ * Fixed-rate control tick implementation for Testicool device
+ *
+ * Timer2 setup: CTC mode (WGM21), prescaler 256, OCR2A = 249
+ *   16 MHz / 256 / 250 = 250 Hz -> one tick every 4 ms
+ *
+ * The ADC itself is run by the ADC engine (adcengine.h); the tick only
+ * latches its latest readings at each sample instant and releases the
+ * sampling tasks.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "controltick.h"
+#include "config.h"
+#include "uart.h"
+#include "scheduler.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// TIMING CONSTANTS
+// ============================================================================
+
+#define TICK_PRESCALER      256
+#define TICK_OCR_VALUE      (F_CPU / TICK_PRESCALER / CONTROL_TICK_HZ - 1)
+#define TICK_MS             (1000 / CONTROL_TICK_HZ)
+#define MS_TO_TICKS(ms)     ((uint16_t)((ms) / TICK_MS))
+
+static_assert(F_CPU % ((unsigned long)TICK_PRESCALER * CONTROL_TICK_HZ) == 0,
+              "CONTROL_TICK_HZ must divide F_CPU/256 exactly");
+static_assert(TICK_OCR_VALUE <= 255, "CONTROL_TICK_HZ too low for 8-bit Timer2");
+static_assert(TEMP_READ_INTERVAL_MS % TICK_MS == 0 && SPEED_READ_INTERVAL_MS % TICK_MS == 0 &&
+              TEMP_RATE_FAST_MS % TICK_MS == 0 && TEMP_RATE_ACTIVE_MS % TICK_MS == 0 &&
+              TEMP_RATE_IDLE_MS % TICK_MS == 0,
+              "Sample intervals must be whole control ticks");
+static_assert(TEMP_RATE_IDLE_MS / TICK_MS <= 0xFFFF, "Sample intervals must fit 16-bit tick counts");
+
+// ADC bursts (adcengine.h) start this many ticks before a sample, so the
+// burst has finished by the sample instant
+#define BURST_LEAD_TICKS  ((uint16_t)((ADC_BURST_US + TICK_MS * 1000UL - 1) / (TICK_MS * 1000UL) + 1))
+
+static_assert(MS_TO_TICKS(ADC_ON_DEMAND_MIN_MS) > BURST_LEAD_TICKS,
+              "ADC_ON_DEMAND_MIN_MS too short for an ADC burst before each sample");
+
+#define NO_TASK      0xFF
+
+// ============================================================================
+// CHANNEL NAMES (flash)
+// ============================================================================
+
+static const char nameTemp[] PROGMEM = "TEMP";
+static const char namePot[] PROGMEM  = "POT";
+
+// Indexed by ControlChannel
+static const char* const channelNames[CTRL_CH_COUNT] PROGMEM = { nameTemp, namePot };
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct ChannelState {
+  // Configuration
+  uint16_t periodTicks;      // Read by the ISR, changed by controlTickSetPeriodMs()
+
+  // Runtime state (written by the ISR)
+  uint8_t notifyTask;
+  uint16_t countdown;
+
+  // Latest sample (written by the ISR); sample.timeUs is also the
+  // previous instant for the jitter statistics
+  ControlSample sample;
+
+  // Jitter statistics (written by the ISR)
+  bool haveLastSample;
+  unsigned long samples;
+  long jitterMinUs;
+  long jitterMaxUs;
+  long jitterSumUs;
+};
+
+// Every member spelled out: partial initializers warn under -Wextra
+static ChannelState channels[CTRL_CH_COUNT] = {
+  // periodTicks                          notify   countdown  sample      have   samples  min  max  sum
+  { MS_TO_TICKS(TEMP_READ_INTERVAL_MS),  NO_TASK, 0,         { { 0 }, 0 }, false, 0,       0,   0,   0 },
+  { MS_TO_TICKS(SPEED_READ_INTERVAL_MS), NO_TASK, 0,         { { 0 }, 0 }, false, 0,       0,   0,   0 }
+};
+
+static bool adcOnDemand = false;   // Every channel slow enough for ADC bursts (read by the ISR)
+
+// ============================================================================
+// PRIVATE HELPERS (called from the ISR)
+// ============================================================================
+
+// Latch the readings of this instant and measure the interval since the last one
+static inline void latchSample(ChannelState& ch) {
+  unsigned long now = micros();
+
+  for (uint8_t i = 0; i < CTRL_SAMPLE_INPUTS; i++) {
+    ch.sample.readings[i] = adcEngineGetValueFromISR(i);
+  }
+
+  if (ch.haveLastSample) {
+    long deviation = (long)(now - ch.sample.timeUs) -
+                     (long)ch.periodTicks * (long)TICK_MS * 1000L;
+    if (ch.samples == 0 || deviation < ch.jitterMinUs) ch.jitterMinUs = deviation;
+    if (ch.samples == 0 || deviation > ch.jitterMaxUs) ch.jitterMaxUs = deviation;
+    ch.jitterSumUs += deviation;
+    ch.samples++;
+  }
+
+  ch.sample.timeUs = now;
+  ch.haveLastSample = true;
+}
+
+// The ADC runs on demand only while every channel samples slowly
+// (interrupts disabled)
+static void updateAdcMode() {
+  bool slow = true;
+  for (uint8_t c = 0; c < CTRL_CH_COUNT; c++) {
+    if (channels[c].periodTicks < MS_TO_TICKS(ADC_ON_DEMAND_MIN_MS)) {
+      slow = false;
+    }
+  }
+
+  if (slow != adcOnDemand) {
+    adcOnDemand = slow;
+    adcEngineSetOnDemand(slow);
+  }
+}
+
+// ============================================================================
+// TIMER2 COMPARE-MATCH INTERRUPT
+// ============================================================================
+
+ISR(TIMER2_COMPA_vect) {
+  for (uint8_t c = 0; c < CTRL_CH_COUNT; c++) {
+    ChannelState& ch = channels[c];
+    if (--ch.countdown != 0) {
+      // On demand the ADC only runs in a burst ahead of each sample
+      if (adcOnDemand && ch.countdown == BURST_LEAD_TICKS) {
+        adcEngineBurstFromISR();
+      }
+      continue;
+    }
+    ch.countdown = ch.periodTicks;
+
+    // Sample now; the control step converts it when it gets to run
+    latchSample(ch);
+    if (ch.notifyTask != NO_TASK) {
+      schedulerTrigger(ch.notifyTask);
+    }
+  }
+}
+
+// ============================================================================
+// CONTROL TICK INITIALIZATION
+// ============================================================================
+
+void controlTickInit() {
+  for (uint8_t c = 0; c < CTRL_CH_COUNT; c++) {
+    // Stagger first releases by channel so they do not share a tick
+    channels[c].countdown = 1 + 2 * c;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR2A = _BV(WGM21);                 // CTC, TOP = OCR2A
+    TCCR2B = _BV(CS22) | _BV(CS21);      // clk/256
+    OCR2A = TICK_OCR_VALUE;
+    TCNT2 = 0;
+    TIFR2 = _BV(OCF2A);                  // Clear stale compare flag
+    TIMSK2 = _BV(OCIE2A);
+  }
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[TICK] Control tick started - "));
+    DEBUG_SERIAL.print(CONTROL_TICK_HZ);
+    DEBUG_SERIAL.println(F(" Hz"));
+  #endif
+}
+
+void controlTickSetNotify(ControlChannel channel, uint8_t taskIndex) {
+  if (channel >= CTRL_CH_COUNT) {
+    return;
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    channels[channel].notifyTask = taskIndex;
+  }
+}
+
+// ============================================================================
+// CHANNEL ACCESS
+// ============================================================================
+
+void controlTickSetPeriodMs(ControlChannel channel, uint16_t periodMs) {
+  if (channel >= CTRL_CH_COUNT) {
+    return;
+  }
+
+  uint16_t ticks = MS_TO_TICKS(periodMs);
+  if (ticks == 0) {
+    ticks = 1;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ChannelState& ch = channels[channel];
+    if (ch.periodTicks != ticks) {
+      ch.periodTicks = ticks;
+      // Do not wait out the rest of a longer old period
+      if (ch.countdown > ticks) {
+        ch.countdown = ticks;
+      }
+      ch.haveLastSample = false;
+      updateAdcMode();
+
+      // Too close to the next sample for the ISR to start its burst
+      if (adcOnDemand && ch.countdown <= BURST_LEAD_TICKS) {
+        adcEngineBurstFromISR();
+      }
+    }
+  }
+}
+
+uint16_t controlTickGetPeriodMs(ControlChannel channel) {
+  if (channel >= CTRL_CH_COUNT) {
+    return 0;
+  }
+
+  uint16_t ticks;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ticks = channels[channel].periodTicks;
+  }
+  return ticks * TICK_MS;
+}
+
+void controlTickGetSample(ControlChannel channel, ControlSample* sample) {
+  if (channel >= CTRL_CH_COUNT || sample == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    *sample = channels[channel].sample;
+  }
+}
+
+// ============================================================================
+// JITTER STATISTICS
+// ============================================================================
+
+void controlTickGetJitter(ControlChannel channel, ControlJitterStats* stats) {
+  if (channel >= CTRL_CH_COUNT || stats == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    const ChannelState& ch = channels[channel];
+    stats->samples = ch.samples;
+    stats->minUs = ch.jitterMinUs;
+    stats->maxUs = ch.jitterMaxUs;
+    stats->meanUs = ch.samples ? ch.jitterSumUs / (long)ch.samples : 0;
+  }
+}
+
+void controlTickResetStats() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t c = 0; c < CTRL_CH_COUNT; c++) {
+      channels[c].haveLastSample = false;
+      channels[c].samples = 0;
+      channels[c].jitterMinUs = 0;
+      channels[c].jitterMaxUs = 0;
+      channels[c].jitterSumUs = 0;
+    }
+  }
+}
+
+char* controlTickGetStatsString(ControlChannel channel, char* buffer, size_t bufferSize) {
+  if (channel >= CTRL_CH_COUNT || buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  char name[8];
+  strncpy_P(name, (const char*)pgm_read_ptr(&channelNames[channel]), sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+
+  ControlJitterStats stats;
+  controlTickGetJitter(channel, &stats);
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("TICK:%s,Period:%ums,Samples:%lu,Jitter:%ld/%ld/%ldus"),
+             name,
+             controlTickGetPeriodMs(channel),
+             stats.samples,
+             stats.minUs,
+             stats.meanUs,
+             stats.maxUs);
+
+  return buffer;
+}
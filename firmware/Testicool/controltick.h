@@ -0,0 +1,120 @@
+/*
+ * controltick.h
+ * Fixed-rate control tick header for Testicool device
+ *
+ * Timer2 runs in CTC mode and fires a compare-match interrupt every
+ * 1/CONTROL_TICK_HZ seconds. Timer0 (millis/micros) and Timer1 (pump PWM
+ * on D9) are left untouched.
+ *
+ * Each sampling channel (temperature, speed potentiometer) has a period
+ * that is a whole number of ticks and can be changed while running (the
+ * temperature rate adapts, see samplerate.h). When a channel is due, the ISR
+ * latches the ADC engine's latest filtered readings with a micros() stamp
+ * and releases the scheduler task that runs its control step; that task
+ * converts the latched readings into the sensor snapshot (sensors.h). The
+ * sample instant no longer depends on how long the main loop spends in
+ * serial output, only the conversion does.
+ *
+ * While every channel's period is at least ADC_ON_DEMAND_MIN_MS, the ADC
+ * engine runs on demand: the tick starts a burst just early enough to
+ * finish at each sample instant (adcengine.h).
+ *
+ * The actual interval between sample instants is measured with micros()
+ * and min/max/mean jitter against the nominal period is kept per channel.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef CONTROLTICK_H
+#define CONTROLTICK_H
+
+#include <Arduino.h>
+#include "adcengine.h"
+
+// Sampling channels driven by the control tick
+enum ControlChannel {
+  CTRL_CH_TEMPERATURE = 0,   // Water + skin thermistors
+  CTRL_CH_SPEED_POT = 1,     // Manual speed potentiometer
+  CTRL_CH_COUNT
+};
+
+#define CTRL_SAMPLE_INPUTS  (ADC_INPUT_POT + 1)   // Temperature channels and the pot
+
+// Readings latched at one sample instant
+struct ControlSample {
+  uint16_t readings[CTRL_SAMPLE_INPUTS];   // ADC engine readings, indexed by AdcInput
+  unsigned long timeUs;                    // micros() at the sample instant
+};
+
+// Jitter statistics of one channel (signed, actual interval - nominal period)
+struct ControlJitterStats {
+  unsigned long samples;     // Number of measured intervals
+  long minUs;                // Most negative deviation
+  long maxUs;                // Most positive deviation
+  long meanUs;               // Mean deviation
+};
+
+// ============================================================================
+// CONTROL TICK FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize the control tick and start Timer2
+ * Call this function once in setup(), after schedulerInit()
+ */
+void controlTickInit();
+
+/**
+ * Set which scheduler task is released when a channel has a new sample
+ * @param channel: sampling channel
+ * @param taskIndex: scheduler task index (see schedulerTrigger())
+ */
+void controlTickSetNotify(ControlChannel channel, uint8_t taskIndex);
+
+/**
+ * Get nominal sample period of a channel
+ * @param channel: sampling channel
+ * @return period in milliseconds
+ */
+uint16_t controlTickGetPeriodMs(ControlChannel channel);
+
+/**
+ * Change the sample period of a channel
+ * A shorter period takes effect at once; the interval spanning the change
+ * is left out of the jitter statistics. Also switches the ADC engine
+ * between continuous and on-demand conversion.
+ * @param channel: sampling channel
+ * @param periodMs: new period in milliseconds (rounded down to whole ticks, at least one)
+ */
+void controlTickSetPeriodMs(ControlChannel channel, uint16_t periodMs);
+
+/**
+ * Get the readings latched at a channel's last sample instant
+ * @param channel: sampling channel
+ * @param sample: structure to fill
+ */
+void controlTickGetSample(ControlChannel channel, ControlSample* sample);
+
+/**
+ * Get sample-interval jitter statistics of a channel
+ * @param channel: sampling channel
+ * @param stats: structure to fill
+ */
+void controlTickGetJitter(ControlChannel channel, ControlJitterStats* stats);
+
+/**
+ * Clear jitter statistics of all channels
+ */
+void controlTickResetStats();
+
+/**
+ * Format jitter statistics of one channel
+ * Format: "TICK:<name>,Period:<ms>,Samples:<n>,Jitter:<min>/<mean>/<max>us"
+ * @param channel: sampling channel
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* controlTickGetStatsString(ControlChannel channel, char* buffer, size_t bufferSize);
+
+#endif // CONTROLTICK_H
@@ -0,0 +1,179 @@
+/*
+ * eco.cpp
+ * Energy-saving pulsed pump control implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "eco.h"
+#include "config.h"
+#include "uart.h"
+#include "pump.h"
+
+static constexpr int16_t ON_TEMP = CENTI_C(ECO_ON_C);
+static constexpr int16_t OFF_TEMP = CENTI_C(ECO_OFF_C);
+
+static_assert(TARGET_TEMP_MIN_C <= OFF_TEMP && OFF_TEMP < ON_TEMP && ON_TEMP <= TARGET_TEMP_MAX_C,
+              "ECO_OFF_C and ECO_ON_C must lie in the target band, off below on");
+static_assert(ECO_LEARN_STEP > 0 && ECO_START_DUTY > ECO_LEARN_STEP && ECO_START_DUTY <= PUMP_MAX_SPEED,
+              "ECO_START_DUTY must be above ECO_LEARN_STEP");
+static_assert(ECO_PULSE_PCT >= 100, "ECO_PULSE_PCT must be at least 100");
+
+// ============================================================================
+// PHASE NAMES (flash)
+// ============================================================================
+
+static const char nameOff[] PROGMEM   = "OFF";
+static const char namePulse[] PROGMEM = "PULSE";
+static const char nameProbe[] PROGMEM = "PROBE";
+
+// Indexed by EcoPhase
+static const char* const phaseNames[] PROGMEM = { nameOff, namePulse, nameProbe };
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static EcoPhase phase = ECO_PHASE_OFF;
+static uint8_t minDuty = ECO_START_DUTY;    // Lowest duty seen to move water
+static uint8_t probeDuty = 0;
+
+static uint32_t phaseStartMs = 0;
+static uint32_t pulseCheckMs = 0;     // Last check that the pulse is cooling
+static int16_t baselineSkinRate = 0;  // Skin warming with the pump stopped
+static bool baselineValid = false;
+
+// Counters and the last cycle, for reporting
+static uint16_t pulseCount = 0;
+static uint16_t probeCount = 0;
+static uint16_t probeFlowCount = 0;
+static uint32_t lastOnMs = 0;
+static uint32_t lastOffMs = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static uint8_t pulseDuty() {
+  return (uint8_t)min((uint16_t)minDuty * ECO_PULSE_PCT / 100, PUMP_MAX_SPEED);
+}
+
+static void enterPhase(EcoPhase next, uint8_t duty, uint32_t now) {
+  phase = next;
+  phaseStartMs = now;
+  pulseCheckMs = now;
+  pumpSetSpeed(duty);
+}
+
+// Judge the probe from how much slower the skin warms than when stopped
+static void finishProbe(const ThermalEstimate& estimate) {
+  int16_t coolRate = baselineSkinRate - estimate.skinRate;
+  bool flowed = (coolRate >= ECO_FLOW_RATE_MC_S);
+
+  probeCount++;
+  if (flowed) {
+    probeFlowCount++;
+    minDuty = probeDuty;
+  } else {
+    minDuty = (uint8_t)min(minDuty + ECO_LEARN_STEP, PUMP_MAX_SPEED);
+  }
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[ECO] Probe at "));
+    DEBUG_SERIAL.print(probeDuty);
+    DEBUG_SERIAL.print(flowed ? F(" flowed (") : F(" no flow ("));
+    DEBUG_SERIAL.print(coolRate);
+    DEBUG_SERIAL.print(F(" mC/s) - min duty "));
+    DEBUG_SERIAL.println(minDuty);
+  #endif
+}
+
+// ============================================================================
+// ECO
+// ============================================================================
+
+void ecoInit() {
+  minDuty = ECO_START_DUTY;
+  pulseCount = 0;
+  probeCount = 0;
+  probeFlowCount = 0;
+  ecoReset();
+}
+
+void ecoReset() {
+  phase = ECO_PHASE_OFF;
+  phaseStartMs = millis();
+  baselineValid = false;
+}
+
+void ecoStep(const ThermalEstimate& estimate) {
+  uint32_t now = millis();
+  if (pumpGetState() != PUMP_ON) {
+    phase = ECO_PHASE_OFF;
+    phaseStartMs = now;
+    return;
+  }
+
+  switch (phase) {
+    case ECO_PHASE_OFF:
+      if (estimate.skinTemp >= ON_TEMP) {
+        // Stopped long enough for the water to settle: a baseline to probe against
+        lastOffMs = now - phaseStartMs;
+        baselineValid = (lastOffMs >= ECO_PROBE_MS);
+        baselineSkinRate = estimate.skinRate;
+        enterPhase(ECO_PHASE_PULSE, pulseDuty(), now);
+      } else if (pumpGetSpeed() != 0) {
+        pumpSetSpeed(0);               // Entering ECO with the pump running
+      }
+      break;
+
+    case ECO_PHASE_PULSE:
+      if (estimate.skinTemp <= OFF_TEMP) {
+        lastOnMs = now - phaseStartMs;
+        pulseCount++;
+        if (baselineValid) {
+          probeDuty = (uint8_t)max((int)minDuty - ECO_LEARN_STEP, ECO_LEARN_STEP);
+          enterPhase(ECO_PHASE_PROBE, probeDuty, now);
+        } else {
+          enterPhase(ECO_PHASE_OFF, 0, now);
+        }
+      } else if (now - pulseCheckMs >= ECO_PROBE_MS) {
+        // Not cooling a probe length in: more flow for the rest of this pulse
+        pulseCheckMs = now;
+        if (estimate.skinTemp > TARGET_TEMP_MAX_C || estimate.skinRate > -ECO_FLOW_RATE_MC_S) {
+          pumpSetSpeed((uint8_t)min(pumpGetSpeed() + ECO_BOOST_STEP, PUMP_MAX_SPEED));
+        }
+      }
+      break;
+
+    case ECO_PHASE_PROBE:
+      if (estimate.skinTemp >= ON_TEMP) {
+        baselineValid = false;         // Needed cooling first: no verdict
+        enterPhase(ECO_PHASE_PULSE, pulseDuty(), now);
+      } else if (now - phaseStartMs >= ECO_PROBE_MS) {
+        finishProbe(estimate);
+        enterPhase(ECO_PHASE_OFF, 0, now);
+      }
+      break;
+  }
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* ecoGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 112) {
+    return NULL;
+  }
+
+  char phaseStr[8];
+  strncpy_P(phaseStr, (const char*)pgm_read_ptr(&phaseNames[phase]), sizeof(phaseStr) - 1);
+  phaseStr[sizeof(phaseStr) - 1] = '\0';
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("ECO:{Phase:%s,MinDuty:%u,PulseDuty:%u,Pulses:%u,Probes:%u/%u,LastOn:%lus,LastOff:%lus}"),
+             phaseStr, minDuty, pulseDuty(), pulseCount, probeFlowCount, probeCount,
+             lastOnMs / 1000, lastOffMs / 1000);
+  return buffer;
+}
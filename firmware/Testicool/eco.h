@@ -0,0 +1,85 @@
+/*
+ * eco.h
+ * Energy-saving pulsed pump control header for Testicool device
+ *
+ * Small DC pumps stall below a threshold duty: the PWM still draws
+ * current, but nothing flows. AUTO mode can settle right there when little
+ * cooling is needed. ECO mode never runs the pump slowly; it pulses it
+ * instead, on skin temperature hysteresis inside the target band:
+ *
+ * - Off until the estimated skin reaches ECO_ON_C, then a pulse
+ * - The pulse runs until the skin is back down to ECO_OFF_C, then off
+ * - Pulse duty = learned minimum effective duty * ECO_PULSE_PCT / 100.
+ *   With flow growing as (duty - stall) and pump power as duty^2, the
+ *   cooling per joule is highest at twice the stall duty (ECO_PULSE_PCT
+ *   200)
+ *
+ * The minimum effective duty is learned from the skin. After a pulse the
+ * pump runs ECO_PROBE_MS one ECO_LEARN_STEP below the current minimum;
+ * the skin is at the bottom of the band then, so the probe has room. If
+ * the estimated skin warms at least ECO_FLOW_RATE_MC_S slower than it did
+ * with the pump stopped before the pulse, the probe duty moves water and
+ * becomes the new minimum; if not, the minimum goes up a step. The
+ * minimum so settles a few steps above the stall point and follows it as
+ * the pump wears or the tubing changes. Probes only follow an off phase
+ * of at least ECO_PROBE_MS (the stopped baseline), and end without a
+ * verdict if the skin reaches ECO_ON_C first.
+ *
+ * A pulse that has not started cooling the skin after ECO_PROBE_MS, or
+ * that leaves the band, gets ECO_BOOST_STEP more duty each ECO_PROBE_MS.
+ * ECO suits light loads, where AUTO would run the pump near the stall;
+ * under a heavy heat load the pulses cannot keep up with the transport
+ * delay and AUTO holds the band far better.
+ *
+ * Pulse length already follows the water temperature, so the water
+ * feedforward (feedforward.h) is not applied in ECO mode; that would move
+ * the pulse off the learned duty. Supply compensation still is.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef ECO_H
+#define ECO_H
+
+#include <Arduino.h>
+#include "estimator.h"
+
+// Pulse phase
+enum EcoPhase {
+  ECO_PHASE_OFF = 0,         // Pump on, duty 0, waiting for ECO_ON_C
+  ECO_PHASE_PULSE,           // Cooling at the pulse duty until ECO_OFF_C
+  ECO_PHASE_PROBE            // After a pulse: testing one step below the minimum
+};
+
+// ============================================================================
+// ECO FUNCTIONS
+// ============================================================================
+
+/**
+ * Start from ECO_START_DUTY as minimum effective duty
+ * Call once in setup()
+ */
+void ecoInit();
+
+/**
+ * Begin in the off phase (the thermostat calls this when ECO is selected)
+ */
+void ecoReset();
+
+/**
+ * Step the pulse control
+ * Called by thermostatUpdate() on every estimator step in ECO mode
+ * @param estimate: latest thermal estimate
+ */
+void ecoStep(const ThermalEstimate& estimate);
+
+/**
+ * Get the pulse state and learning as formatted string
+ * Format: "ECO:{Phase:<OFF|PROBE|PULSE>,MinDuty:<0-255>,PulseDuty:<0-255>,Pulses:<n>,Probes:<flowed>/<n>,LastOn:<s>,LastOff:<s>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* ecoGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // ECO_H
@@ -0,0 +1,82 @@
+/*
+ * eepromwrite.cpp
+ * Interrupt-driven EEPROM writer implementation for Testicool device
+ *
+ * EE_READY fires continuously while the EEPROM is idle and EERIE is set,
+ * so EERIE stays set only while bytes are left. Each interrupt checks
+ * bytes until one differs, starts its erase + write (EEPM = 00, 3.4 ms)
+ * and returns; unchanged bytes cost one 4-cycle read each.
+ *
+ * Nothing else may write the EEPROM once a record has been started;
+ * eeprom_read_block() is only used at boot, before that.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "eepromwrite.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct WriteJob {
+  const uint8_t* data;
+  uint16_t address;
+  uint8_t size;
+  uint8_t done;              // Bytes checked or written so far
+};
+
+static WriteJob jobs[EEPROM_RECORD_COUNT];   // Shared with the ISR (accessed atomically)
+
+// ============================================================================
+// EEPROM READY INTERRUPT
+// ============================================================================
+
+ISR(EE_READY_vect) {
+  for (uint8_t r = 0; r < EEPROM_RECORD_COUNT; r++) {
+    WriteJob& job = jobs[r];
+    while (job.done < job.size) {
+      uint8_t value = job.data[job.done];
+      EEAR = job.address + job.done;
+      job.done++;
+
+      EECR |= _BV(EERE);
+      if (EEDR != value) {
+        EEDR = value;
+        EECR |= _BV(EEMPE);      // EEPE must follow within 4 cycles
+        EECR |= _BV(EEPE);
+        return;                  // Back here when this byte is written
+      }
+    }
+  }
+
+  EECR &= ~_BV(EERIE);           // Nothing left
+}
+
+// ============================================================================
+// EEPROM WRITER
+// ============================================================================
+
+void eepromWriteStart(EepromRecord record, uint16_t address, const void* data, uint8_t size) {
+  if (record >= EEPROM_RECORD_COUNT || data == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    WriteJob& job = jobs[record];
+    job.data = (const uint8_t*)data;
+    job.address = address;
+    job.size = size;
+    job.done = 0;
+    EECR |= _BV(EERIE);          // Fires at once if the EEPROM is idle
+  }
+}
+
+bool eepromWriteBusy() {
+  bool busy;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    busy = (EECR & _BV(EERIE)) != 0;
+  }
+  return busy;
+}
@@ -0,0 +1,53 @@
+/*
+ * eepromwrite.h
+ * Interrupt-driven EEPROM writer header for Testicool device
+ *
+ * An EEPROM byte takes about 3.4 ms to erase and write, so
+ * eeprom_update_block() of a stored record blocked the calling task for
+ * tens of milliseconds, well past its deadline. Records are handed to
+ * this writer instead: the EE_READY interrupt writes the next changed
+ * byte each time the EEPROM finishes the previous one, and the caller
+ * returns at once.
+ *
+ * Every stored record has its own slot. Starting a record again while
+ * it is still being written restarts it with the new data, so the last
+ * start always wins. The data is read as it is written: it must stay in
+ * place (static storage of the owning module) until the record is done.
+ * A record cut short by a reset fails its CRC at the next boot.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef EEPROMWRITE_H
+#define EEPROMWRITE_H
+
+#include <Arduino.h>
+
+// One slot per stored record
+enum EepromRecord {
+  EEPROM_RECORD_CALIBRATION = 0,   // calibration.h, at CAL_EEPROM_ADDR
+  EEPROM_RECORD_AUTOTUNE,          // autotune.h, at TUNE_EEPROM_ADDR
+  EEPROM_RECORD_COUNT
+};
+
+// ============================================================================
+// EEPROM WRITER FUNCTIONS
+// ============================================================================
+
+/**
+ * Start writing a record in the background
+ * Bytes that already hold the value are skipped, like eeprom_update_block()
+ * @param record: slot of the record (replaces any write of it in progress)
+ * @param address: EEPROM address of the first byte
+ * @param data: bytes to write; must stay unchanged until the write is done
+ * @param size: number of bytes
+ */
+void eepromWriteStart(EepromRecord record, uint16_t address, const void* data, uint8_t size);
+
+/**
+ * Check whether any record is still being written
+ * @return true while bytes are left
+ */
+bool eepromWriteBusy();
+
+#endif // EEPROMWRITE_H
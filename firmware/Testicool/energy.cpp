@@ -0,0 +1,125 @@
+/*
+ * energy.cpp
+ * Pump duty cycle and energy accounting implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "energy.h"
+#include "config.h"
+#include "pump.h"
+#include "supply.h"
+#include "thermostat.h"
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// Totals are kept in whole units with the remainder carried, so 100 ms
+// steps add up exactly over hours
+struct EnergyTotals {
+  uint32_t onMs;             // Pump ON
+  uint32_t flowingMs;        // Pump ON with a nonzero duty
+  uint32_t dutySeconds;      // Sum of duty * seconds while ON
+  uint32_t energyMj;         // Millijoules
+  uint16_t dutyRemainder;    // Duty * ms not yet a duty-second
+  uint16_t energyRemainder;  // Microjoules not yet a millijoule
+};
+
+static EnergyTotals totals[THERMOSTAT_MODE_COUNT];
+static uint32_t lastMs = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static void accumulate(uint32_t* total, uint16_t* remainder, uint32_t amount) {
+  amount += *remainder;
+  *total += amount / 1000;
+  *remainder = (uint16_t)(amount % 1000);
+}
+
+// Resistive model: power grows with the square of the average pump voltage
+static uint32_t pumpPowerMw(uint16_t duty) {
+  uint16_t supplyMv = supplyGetPumpMv();
+  if (supplyMv < PUMP_SUPPLY_MIN_MV) {
+    supplyMv = PUMP_SUPPLY_NOMINAL_MV;  // Not measured
+  }
+
+  // Average voltage over nominal, 16.16
+  uint32_t ratio = ((uint32_t)duty * supplyMv / PUMP_HIRES_MAX << 16) / PUMP_SUPPLY_NOMINAL_MV;
+  return (((uint32_t)PUMP_FULL_POWER_MW * ratio) >> 16) * ratio >> 16;
+}
+
+// ============================================================================
+// ENERGY
+// ============================================================================
+
+void energyInit() {
+  energyReset();
+}
+
+void energyUpdate() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - lastMs;
+  lastMs = now;
+
+  if (pumpGetState() != PUMP_ON) {
+    return;
+  }
+
+  EnergyTotals& t = totals[thermostatGetMode()];
+  uint16_t duty = pumpGetDutyHiRes();
+
+  t.onMs += elapsed;
+  if (duty > 0) {
+    t.flowingMs += elapsed;
+    accumulate(&t.dutySeconds, &t.dutyRemainder, (uint32_t)HIRES_TO_SPEED(duty) * elapsed);
+    accumulate(&t.energyMj, &t.energyRemainder, pumpPowerMw(duty) * elapsed);
+  }
+}
+
+void energyReset() {
+  memset(totals, 0, sizeof(totals));
+  lastMs = millis();
+}
+
+uint8_t energyGetModeCount() {
+  return THERMOSTAT_MODE_COUNT;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* energyGetModeString(uint8_t mode, char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 96 || mode >= THERMOSTAT_MODE_COUNT) {
+    return NULL;
+  }
+
+  const EnergyTotals& t = totals[mode];
+  char name[THERMOSTAT_MODE_NAME_SIZE];
+  thermostatGetModeName((ThermostatMode)mode, name, sizeof(name));
+  uint32_t onSeconds = t.onMs / 1000;
+
+  if (onSeconds == 0) {
+    snprintf_P(buffer, bufferSize, PSTR("ENERGY:%s,On:0s,Flowing:-,Duty:-,Energy:0.0J,Power:-,Life:-"), name);
+    return buffer;
+  }
+
+  uint32_t powerMw = t.energyMj / onSeconds;     // mJ/s
+  char lifeStr[12];
+  if (powerMw == 0) {
+    strcpy_P(lifeStr, PSTR("-"));
+  } else {
+    snprintf_P(lifeStr, sizeof(lifeStr), PSTR("%lumin"), (uint32_t)BATTERY_CAPACITY_MWH * 60 / powerMw);
+  }
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("ENERGY:%s,On:%lus,Flowing:%u%%,Duty:%u,Energy:%lu.%luJ,Power:%lumW,Life:%s"),
+             name, onSeconds,
+             (unsigned)(t.flowingMs / (t.onMs / 100)),
+             (unsigned)(t.dutySeconds / onSeconds),
+             t.energyMj / 1000, (t.energyMj / 100) % 10, powerMw, lifeStr);
+  return buffer;
+}
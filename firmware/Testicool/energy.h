@@ -0,0 +1,71 @@
+/*
+ * energy.h
+ * Pump duty cycle and energy accounting header for Testicool device
+ *
+ * Integrates what the pump draws, separately for each control mode, so
+ * sessions in ECO, AUTO and MANUAL can be compared on battery life:
+ *
+ * - On time (pump ON), flowing time (ON with a nonzero duty) and the mean
+ *   duty while on
+ * - Energy from a resistive pump model: the average voltage across the
+ *   pump is duty/255 of the pump supply (measured with the divider, else
+ *   PUMP_SUPPLY_NOMINAL_MV), and
+ *
+ *     P = PUMP_FULL_POWER_MW * (Vavg / PUMP_SUPPLY_NOMINAL_MV)^2
+ *
+ *   Measure one unit's supply current at full duty for PUMP_FULL_POWER_MW;
+ *   a real motor draws less than this model at mid duties once it spins
+ * - Battery life at the mode's mean pump power, for BATTERY_CAPACITY_MWH
+ *   (the pump only; the Nano and the Bluetooth module come on top)
+ *
+ * The POT task samples the pump every estimator step (100 ms), which
+ * resolves ECO pulses of a few seconds well.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// ENERGY FUNCTIONS
+// ============================================================================
+
+/**
+ * Clear the totals and start timing
+ * Call once in setup()
+ */
+void energyInit();
+
+/**
+ * Add the time since the last call at the current duty to the current
+ * mode's totals
+ * Called on every estimator step (POT task)
+ */
+void energyUpdate();
+
+/**
+ * Clear the totals of every mode
+ */
+void energyReset();
+
+/**
+ * Get one control mode's totals as formatted string
+ * Format: "ENERGY:<mode>,On:<s>,Flowing:<%>,Duty:<mean>,Energy:<J>,Power:<mW>,Life:<min>"
+ * (Flowing, Duty, Power and Life show "-" before the pump has run in the mode)
+ * @param mode: ThermostatMode
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* energyGetModeString(uint8_t mode, char* buffer, size_t bufferSize);
+
+/**
+ * Get the number of lines of the ENERGY report (one per control mode)
+ * @return line count
+ */
+uint8_t energyGetModeCount();
+
+#endif // ENERGY_H
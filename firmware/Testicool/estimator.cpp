@@ -0,0 +1,203 @@
+/*
+ * estimator.cpp
+ * Thermal state estimator implementation for Testicool device
+ *
+ * Per sensor, with T the step in seconds, the predict/correct step is
+ *
+ *   temp' = temp + (rate - input) * T        rate' = rate
+ *   e     = measured - temp'
+ *   temp  = temp' + alpha * e                rate  = rate' + (beta / T) * e
+ *
+ * alpha and beta are the steady-state Kalman gains of that model for white
+ * rate-of-change noise, from the tracking index (Kalata), for every step
+ * period the control step runs at
+ *
+ *   lambda = accelNoise * T^2 / sensorNoise
+ *   r      = (4 + lambda - sqrt(8 lambda + lambda^2)) / 4
+ *   alpha  = 1 - r^2         beta = 2 (2 - alpha) - 4 sqrt(1 - alpha)
+ *
+ * State is kept in 1/256 of a hundredth of a degree (and per second), so
+ * small corrections are not lost to rounding. Products with a gain go
+ * through 64-bit intermediates; one step costs a few of them.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "estimator.h"
+#include "config.h"
+#include "uart.h"
+
+#define STATE_SHIFT  8           // State fraction bits
+
+// ============================================================================
+// COMPILE-TIME GAINS
+// ============================================================================
+
+static constexpr double sqrtNewton(double x, double guess, int n) {
+  return n == 0 ? guess : sqrtNewton(x, 0.5 * (guess + x / guess), n - 1);
+}
+
+static constexpr double constSqrt(double x) {
+  return x <= 0.0 ? 0.0 : sqrtNewton(x, x < 1.0 ? 1.0 : x, 40);
+}
+
+static constexpr double lambdaFor(double stepS) {
+  return ESTIMATOR_ACCEL_NOISE_C * stepS * stepS / ESTIMATOR_SENSOR_NOISE_C;
+}
+
+static constexpr double rFor(double lambda) {
+  return (4.0 + lambda - constSqrt(8.0 * lambda + lambda * lambda)) / 4.0;
+}
+
+static constexpr double alphaFor(double stepS) {
+  return 1.0 - rFor(lambdaFor(stepS)) * rFor(lambdaFor(stepS));
+}
+
+static constexpr double betaFor(double stepS) {
+  return 2.0 * (2.0 - alphaFor(stepS)) - 4.0 * constSqrt(1.0 - alphaFor(stepS));
+}
+
+// Gains in 1/65536 for a step of periodMs
+static constexpr int32_t alphaQ16(uint16_t periodMs) {
+  return (int32_t)(alphaFor(periodMs / 1000.0) * 65536.0 + 0.5);
+}
+
+static constexpr int32_t betaPerSQ16(uint16_t periodMs) {
+  return (int32_t)(betaFor(periodMs / 1000.0) / (periodMs / 1000.0) * 65536.0 + 0.5);
+}
+
+static constexpr bool gainsUsable(uint16_t periodMs) {
+  return alphaQ16(periodMs) > 0 && alphaQ16(periodMs) < 65536 && betaPerSQ16(periodMs) > 0;
+}
+
+static constexpr int32_t COOLING_Q16 = (int32_t)(ESTIMATOR_COOLING_PER_S * 65536.0 + 0.5);
+
+static_assert(gainsUsable(ESTIMATOR_PERIOD_MS) && gainsUsable(TEMP_RATE_FAST_MS) &&
+              gainsUsable(TEMP_RATE_ACTIVE_MS) && gainsUsable(TEMP_READ_INTERVAL_MS) &&
+              gainsUsable(TEMP_RATE_IDLE_MS),
+              "Estimator noise settings give no usable gains at some step period");
+static_assert(COOLING_Q16 >= 0 && COOLING_Q16 < 65536, "ESTIMATOR_COOLING_PER_S must be 0..1");
+
+// One row per step period the control step runs at (see samplerate.h)
+struct StepGains {
+  uint16_t periodMs;
+  int32_t alphaQ16;
+  int32_t betaPerSQ16;
+};
+
+#define STEP_GAINS(ms)  { ms, alphaQ16(ms), betaPerSQ16(ms) }
+
+static const StepGains gainTable[] PROGMEM = {
+  STEP_GAINS(ESTIMATOR_PERIOD_MS),
+  STEP_GAINS(TEMP_RATE_FAST_MS),
+  STEP_GAINS(TEMP_RATE_ACTIVE_MS),
+  STEP_GAINS(TEMP_READ_INTERVAL_MS),
+  STEP_GAINS(TEMP_RATE_IDLE_MS)
+};
+
+#define GAIN_TABLE_SIZE  (sizeof(gainTable) / sizeof(gainTable[0]))
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// One sensor's state, both scaled by 2^STATE_SHIFT
+struct Track {
+  int32_t temp;              // Hundredths of a degree
+  int32_t rate;              // Hundredths of a degree per second
+};
+
+static Track skin;
+static Track water;
+static int32_t cooling = 0;  // Last modelled pump cooling, same units as rate
+static ThermalEstimate estimate;
+static StepGains gains;      // Row of gainTable for the current step period
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static inline int32_t mulQ16(int32_t value, int32_t gainQ16) {
+  return (int32_t)(((int64_t)value * gainQ16 + 0x8000) >> 16);
+}
+
+// Load the gains of the table row closest to the step period
+static void selectGains(uint16_t periodMs) {
+  uint8_t best = 0;
+  uint16_t bestDistance = 0xFFFF;
+  for (uint8_t i = 0; i < GAIN_TABLE_SIZE; i++) {
+    uint16_t rowMs = pgm_read_word(&gainTable[i].periodMs);
+    uint16_t distance = (rowMs > periodMs) ? rowMs - periodMs : periodMs - rowMs;
+    if (distance < bestDistance) {
+      best = i;
+      bestDistance = distance;
+    }
+  }
+  memcpy_P(&gains, &gainTable[best], sizeof(gains));
+}
+
+static void step(Track* track, int32_t input, int16_t measured, uint16_t periodMs) {
+  // Predict: integrate the rate over one step
+  track->temp += (int32_t)((int64_t)(track->rate - input) * periodMs / 1000);
+
+  // Correct with the residual
+  int32_t residual = (int32_t)measured * (1L << STATE_SHIFT) - track->temp;
+  track->temp += mulQ16(residual, gains.alphaQ16);
+  track->rate += mulQ16(residual, gains.betaPerSQ16);
+}
+
+static int16_t toCenti(int32_t scaled) {
+  int32_t value = (scaled + (1L << (STATE_SHIFT - 1))) >> STATE_SHIFT;
+  return (int16_t)constrain(value, -32767L, 32767L);
+}
+
+static int16_t toMilliPerSecond(int32_t scaled) {
+  int32_t value = (scaled * 10 + (1L << (STATE_SHIFT - 1))) >> STATE_SHIFT;
+  return (int16_t)constrain(value, -32767L, 32767L);
+}
+
+static void publish() {
+  estimate.skinTemp = toCenti(skin.temp);
+  estimate.waterTemp = toCenti(water.temp);
+  estimate.skinRate = toMilliPerSecond(skin.rate - cooling);
+  estimate.waterRate = toMilliPerSecond(water.rate);
+  estimate.coolingRate = toMilliPerSecond(cooling);
+}
+
+// ============================================================================
+// ESTIMATOR
+// ============================================================================
+
+void estimatorInit(int16_t skinTemp, int16_t waterTemp) {
+  skin.temp = (int32_t)skinTemp * (1L << STATE_SHIFT);
+  skin.rate = 0;
+  water.temp = (int32_t)waterTemp * (1L << STATE_SHIFT);
+  water.rate = 0;
+  cooling = 0;
+  selectGains(ESTIMATOR_PERIOD_MS);
+  publish();
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[EST] Gains alpha/beta (1/65536): "));
+    DEBUG_SERIAL.print(gains.alphaQ16);
+    DEBUG_SERIAL.print(F(" / "));
+    DEBUG_SERIAL.println(gains.betaPerSQ16);
+  #endif
+}
+
+void estimatorUpdate(int16_t skinTemp, int16_t waterTemp, uint8_t pumpSpeed, uint16_t periodMs) {
+  if (periodMs != gains.periodMs) {
+    selectGains(periodMs);
+  }
+
+  // Pump cooling from the previous estimate; heating when the water is warmer
+  cooling = mulQ16(skin.temp - water.temp, COOLING_Q16) * pumpSpeed / 255;
+
+  step(&skin, cooling, skinTemp, periodMs);
+  step(&water, 0, waterTemp, periodMs);
+  publish();
+}
+
+const ThermalEstimate& estimatorGet() {
+  return estimate;
+}
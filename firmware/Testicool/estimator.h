@@ -0,0 +1,68 @@
+/*
+ * estimator.h
+ * Thermal state estimator header for Testicool device
+ *
+ * A fixed-point Kalman filter tracks the skin and water temperatures
+ * together with their rates of change, from the snapshot readings and the
+ * commanded pump speed. Each sensor has a constant-rate model (temperature
+ * and rate of change); the skin model also subtracts the heat the pump
+ * removes, modelled as
+ *
+ *   cooling = ESTIMATOR_COOLING_PER_S * speed/255 * (skin - water)
+ *
+ * so a pump start or speed change shows up in the prediction at once
+ * instead of having to be learned from the residuals.
+ *
+ * The filter steps with the control step: every ESTIMATOR_PERIOD_MS while
+ * the pump runs, at the temperature sampling period while it is off (see
+ * samplerate.h). Each of those periods has its own steady-state Kalman
+ * gains, computed at compile time from the noise settings in config.h. A ramp is tracked without lag, unlike a moving
+ * average, while noise is reduced more than the snapshot filter alone.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include <Arduino.h>
+
+// Estimated thermal state
+struct ThermalEstimate {
+  int16_t skinTemp;          // Hundredths of a degree Celsius
+  int16_t waterTemp;         // Hundredths of a degree Celsius
+  int16_t skinRate;          // Thousandths of a degree per second, net (heating minus cooling)
+  int16_t waterRate;         // Thousandths of a degree per second
+  int16_t coolingRate;       // Thousandths of a degree per second removed from the skin by the pump
+};
+
+// ============================================================================
+// ESTIMATOR FUNCTIONS
+// ============================================================================
+
+/**
+ * Start the estimator at the given temperatures, with zero rates
+ * Call once in setup(), after sensorsInit()
+ * @param skinTemp: skin temperature (hundredths of a degree)
+ * @param waterTemp: water temperature (hundredths of a degree)
+ */
+void estimatorInit(int16_t skinTemp, int16_t waterTemp);
+
+/**
+ * Advance the estimate by one step and correct it with new readings
+ * Called by the POT task on every control step
+ * @param skinTemp: measured skin temperature (hundredths of a degree)
+ * @param waterTemp: measured water temperature (hundredths of a degree)
+ * @param pumpSpeed: commanded pump speed over the step, 0-255 (0 = off)
+ * @param periodMs: step period, ESTIMATOR_PERIOD_MS or a TEMP_RATE_* period
+ *                  (the gains of the closest one are used)
+ */
+void estimatorUpdate(int16_t skinTemp, int16_t waterTemp, uint8_t pumpSpeed, uint16_t periodMs);
+
+/**
+ * Get the current estimate
+ * @return estimate (valid until the next estimatorUpdate())
+ */
+const ThermalEstimate& estimatorGet();
+
+#endif // ESTIMATOR_H
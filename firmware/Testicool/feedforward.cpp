@@ -0,0 +1,106 @@
+/*
+ * feedforward.cpp
+ * Water temperature feedforward implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "feedforward.h"
+#include "config.h"
+#include "uart.h"
+#include "thermostat.h"
+#include "bluetooth.h"
+
+#define SCALE_ONE         256                                   // 1.0 in 8.8 fixed point
+#define SCALE_MIN         ((uint16_t)FEEDFORWARD_MIN_PCT * SCALE_ONE / 100)
+#define SCALE_MAX         ((uint16_t)FEEDFORWARD_MAX_PCT * SCALE_ONE / 100)
+
+static constexpr int16_t REF_WATER = CENTI_C(FEEDFORWARD_REF_WATER_C);
+static constexpr uint16_t MIN_LEVEL = SPEED_TO_HIRES(THERMOSTAT_MIN_DUTY);
+static constexpr uint16_t MAX_LEVEL = SPEED_TO_HIRES(PUMP_MAX_SPEED);
+
+static_assert(FEEDFORWARD_MIN_PCT > 0 && FEEDFORWARD_MIN_PCT <= 100 &&
+              FEEDFORWARD_MAX_PCT >= 100 && FEEDFORWARD_MAX_PCT <= 400,
+              "FEEDFORWARD_MIN_PCT must be 1-100, FEEDFORWARD_MAX_PCT 100-400");
+static_assert(REF_WATER < TARGET_TEMP_MIN_C, "FEEDFORWARD_REF_WATER_C must be below the target band");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static bool enabled = FEEDFORWARD_ENABLED;
+static uint16_t scale = SCALE_ONE;    // 8.8, applied to every commanded speed
+static int16_t waterTemp = REF_WATER;
+
+// ============================================================================
+// FEEDFORWARD
+// ============================================================================
+
+void feedforwardInit() {
+  enabled = FEEDFORWARD_ENABLED;
+  scale = SCALE_ONE;
+  waterTemp = REF_WATER;
+}
+
+void feedforwardUpdate(const ThermalEstimate& estimate) {
+  waterTemp = estimate.waterTemp;
+
+  // Cooling per unit of flow follows target - water; keep speed * that constant
+  int32_t refDiff = thermostatGetTarget() - REF_WATER;
+  int32_t diff = thermostatGetTarget() - waterTemp;
+  if (diff * SCALE_MAX <= refDiff * SCALE_ONE) {
+    scale = SCALE_MAX;                // Water at or above the target counts as warmest
+  } else {
+    scale = (uint16_t)constrain((refDiff * SCALE_ONE + diff / 2) / diff, (int32_t)SCALE_MIN, (int32_t)SCALE_MAX);
+  }
+}
+
+uint16_t feedforwardApply(uint16_t level) {
+  // MANUAL only: AUTO's PID already follows the water (scaling it costs
+  // energy), ECO pulses at its learned duty, and TUNE's relay must swing
+  // by the RELAY_HALF_SWING autotune.cpp's finish() assumes
+  if (!enabled || level == 0 || thermostatGetMode() != THERMOSTAT_MANUAL) {
+    return level;
+  }
+
+  uint32_t scaled = ((uint32_t)level * scale + SCALE_ONE / 2) / SCALE_ONE;
+  if (level >= MIN_LEVEL && scaled < MIN_LEVEL) {
+    scaled = MIN_LEVEL;               // Less flow, but not a stalled pump
+  }
+  return (uint16_t)min(scaled, (uint32_t)MAX_LEVEL);
+}
+
+void feedforwardSetEnabled(bool on) {
+  enabled = on;
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(on ? F("[FF] Water feedforward on") : F("[FF] Water feedforward off"));
+  #endif
+}
+
+bool feedforwardIsEnabled() {
+  return enabled;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* feedforwardGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 64) {
+    return NULL;
+  }
+
+  char waterStr[8];
+  char refStr[8];
+  bluetoothFormatTemperature(waterTemp, waterStr, sizeof(waterStr));
+  bluetoothFormatTemperature(REF_WATER, refStr, sizeof(refStr));
+
+  char enabledStr[4];
+  strcpy_P(enabledStr, enabled ? PSTR("ON") : PSTR("OFF"));
+
+  snprintf_P(buffer, bufferSize, PSTR("FF:{Enabled:%s,Water:%sC,Ref:%sC,Scale:%u%%}"),
+             enabledStr, waterStr, refStr,
+             enabled ? (unsigned)((scale * 100UL + SCALE_ONE / 2) / SCALE_ONE) : 100U);
+  return buffer;
+}
@@ -0,0 +1,91 @@
+/*
+ * feedforward.h
+ * Water temperature feedforward header for Testicool device
+ *
+ * The heat the loop takes from the skin grows with flow and with the
+ * difference between skin and water. Water from a fresh ice reservoir
+ * removes about three times as much per unit of flow as water that has
+ * warmed to 25°C, so a fixed speed over-cools at the start of a session
+ * and falls behind near its end.
+ *
+ * In MANUAL mode the feedforward scales the commanded speed (pot or
+ * SPEED) before it reaches the PWM:
+ *
+ *   duty = speed * (target - FEEDFORWARD_REF_WATER_C) / (target - water)
+ *
+ * with the estimated water temperature and the middle of the target band
+ * as the skin side. The target is used rather than the measured skin: a
+ * warm skin would otherwise reduce the flow, which is the wrong way round.
+ * At FEEDFORWARD_REF_WATER_C the speed passes unchanged; colder water
+ * gets less flow and warmer water more, limited to FEEDFORWARD_MIN_PCT ..
+ * FEEDFORWARD_MAX_PCT. The cooling a given speed delivers then stays about
+ * the same as the reservoir warms, so the flow follows the water before
+ * the skin temperature starts to drift.
+ *
+ * The other modes pass the speed through. AUTO's PID already raises the
+ * speed as the water warms; scaled as well, it used about 5% more pump
+ * energy over a simulated 30-minute session (firmware/test/session_sim)
+ * for 3% more time in the target band. ECO pulses at its learned duty
+ * (see eco.h), and TUNE's relay must swing by exactly the amplitude
+ * autotune.cpp computes the gains from.
+ *
+ * Speeds that would run the pump are never scaled below
+ * THERMOSTAT_MIN_DUTY, where it stalls.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef FEEDFORWARD_H
+#define FEEDFORWARD_H
+
+#include <Arduino.h>
+#include "estimator.h"
+
+// ============================================================================
+// FEEDFORWARD FUNCTIONS
+// ============================================================================
+
+/**
+ * Start from the config.h setting with a neutral scale
+ * Call once in setup()
+ */
+void feedforwardInit();
+
+/**
+ * Follow the estimated water temperature
+ * Called on every estimator step (POT task); call pumpRefreshDuty() after
+ * it so the new scale reaches the PWM
+ * @param estimate: latest thermal estimate
+ */
+void feedforwardUpdate(const ThermalEstimate& estimate);
+
+/**
+ * Scale a commanded speed for the water temperature
+ * @param level: speed as commanded, 0-PUMP_HIRES_MAX (see pump.h)
+ * @return level giving the same cooling at the current water temperature
+ *         (level itself while disabled), at most SPEED_TO_HIRES(PUMP_MAX_SPEED)
+ */
+uint16_t feedforwardApply(uint16_t level);
+
+/**
+ * Turn the feedforward on or off (for A/B comparison)
+ * @param enabled: true to scale speeds
+ */
+void feedforwardSetEnabled(bool enabled);
+
+/**
+ * Check whether the feedforward is on
+ * @return true if speeds are scaled
+ */
+bool feedforwardIsEnabled();
+
+/**
+ * Get the feedforward state as formatted string
+ * Format: "FF:{Enabled:<ON|OFF>,Water:<C>,Ref:<C>,Scale:<%>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* feedforwardGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // FEEDFORWARD_H
@@ -0,0 +1,128 @@
+/*
+ * filter.cpp
+ * Sample filter implementation for Testicool device
+ *
+ * The medians are the minimal exchange networks (7 exchanges for 5
+ * inputs, 13 for 7) run on a copy of the window; each exchange is a
+ * compare and two stores, with no loop and no data-dependent path length.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "filter.h"
+
+static_assert(FILTER_MEDIAN_SIZE == 1 || FILTER_MEDIAN_SIZE == 5 || FILTER_MEDIAN_SIZE == 7,
+              "FILTER_MEDIAN_SIZE must be 1, 5 or 7");
+static_assert(FILTER_EMA_SHIFT <= 8, "FILTER_EMA_SHIFT must be 0..8");
+
+#define BENCH_SAMPLES  64
+#define BENCH_PASSES   4
+
+// ============================================================================
+// MEDIAN NETWORKS
+// ============================================================================
+
+// Order two values: a gets the smaller, b the larger
+#define EXCHANGE(a, b) { uint16_t lo = (a) < (b) ? (a) : (b); (b) = (a) ^ (b) ^ lo; (a) = lo; }
+
+static inline uint16_t median(const uint16_t* window) {
+  #if FILTER_MEDIAN_SIZE == 5
+    uint16_t p0 = window[0], p1 = window[1], p2 = window[2], p3 = window[3], p4 = window[4];
+    EXCHANGE(p0, p1); EXCHANGE(p3, p4); EXCHANGE(p0, p3);
+    EXCHANGE(p1, p4); EXCHANGE(p1, p2); EXCHANGE(p2, p3);
+    EXCHANGE(p1, p2);
+    return p2;
+  #elif FILTER_MEDIAN_SIZE == 7
+    uint16_t p0 = window[0], p1 = window[1], p2 = window[2], p3 = window[3],
+             p4 = window[4], p5 = window[5], p6 = window[6];
+    EXCHANGE(p0, p5); EXCHANGE(p0, p3); EXCHANGE(p1, p6);
+    EXCHANGE(p2, p4); EXCHANGE(p0, p1); EXCHANGE(p3, p5);
+    EXCHANGE(p2, p6); EXCHANGE(p2, p3); EXCHANGE(p3, p6);
+    EXCHANGE(p4, p5); EXCHANGE(p1, p4); EXCHANGE(p1, p3);
+    EXCHANGE(p3, p4);
+    return p3;
+  #else
+    return window[0];
+  #endif
+}
+
+// ============================================================================
+// FILTER
+// ============================================================================
+
+void filterReset(SampleFilter* filter, uint16_t initial) {
+  for (uint8_t i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+    filter->window[i] = initial;
+  }
+  filter->next = 0;
+  filter->raw = initial;
+  filter->emaScaled = (uint32_t)initial << FILTER_EMA_SHIFT;
+  filter->variance = 0;
+}
+
+uint16_t filterAdd(SampleFilter* filter, uint16_t sample) {
+  filter->raw = sample;
+  filter->window[filter->next] = sample;
+  if (++filter->next >= FILTER_MEDIAN_SIZE) {
+    filter->next = 0;
+  }
+
+  // ema += (median - ema) / 2^shift, kept scaled so no fraction is lost
+  filter->emaScaled -= filter->emaScaled >> FILTER_EMA_SHIFT;
+  filter->emaScaled += median(filter->window);
+
+  // var += (deviation^2 - var) / 2^shift, deviation of the raw reading
+  int16_t deviation = (int16_t)sample - (int16_t)(filter->emaScaled >> FILTER_EMA_SHIFT);
+  int32_t step = (int32_t)deviation * deviation - (int32_t)filter->variance;
+  filter->variance += step >> FILTER_EMA_SHIFT;
+
+  return filterGetValue(filter);
+}
+
+uint16_t filterGetValue(const SampleFilter* filter) {
+  #if FILTER_EMA_SHIFT > 0
+    return (uint16_t)((filter->emaScaled + (1UL << (FILTER_EMA_SHIFT - 1))) >> FILTER_EMA_SHIFT);
+  #else
+    return (uint16_t)filter->emaScaled;
+  #endif
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+char* filterGetBenchmarkString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 80) {
+    return NULL;
+  }
+
+  SampleFilter bench;
+  filterReset(&bench, 2000);
+
+  // Noise of a few LSB with an occasional full-scale spike
+  uint16_t seed = 0xACE1;
+  unsigned long bestUs = 0xFFFFFFFFUL;
+  for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+    unsigned long start = micros();
+    for (uint8_t i = 0; i < BENCH_SAMPLES; i++) {
+      seed = seed * 25173U + 13849U;
+      uint16_t sample = ((i & 15) == 7) ? 4092 : 2000 + (seed >> 13);
+      filterAdd(&bench, sample);
+    }
+    unsigned long elapsed = micros() - start;
+    if (elapsed < bestUs) {
+      bestUs = elapsed;
+    }
+  }
+
+  unsigned long hundredths = bestUs * 100UL / BENCH_SAMPLES;
+  snprintf_P(buffer, bufferSize,
+             PSTR("FILTER:BENCH,Median:%u,EmaShift:%u,Samples:%u,PerSample:%lu.%02luus"),
+             FILTER_MEDIAN_SIZE,
+             FILTER_EMA_SHIFT,
+             BENCH_SAMPLES,
+             hundredths / 100,
+             hundredths % 100);
+
+  return buffer;
+}
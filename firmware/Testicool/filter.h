@@ -0,0 +1,72 @@
+/*
+ * filter.h
+ * Sample filter header for Testicool device
+ *
+ * One SampleFilter per ADC input, fed with every finished reading:
+ * 1. Median despiker over the last FILTER_MEDIAN_SIZE readings (5 or 7;
+ *    1 turns it off) - a spike shorter than half the window never
+ *    reaches the output
+ * 2. Integer exponential moving average of the median, weight
+ *    1/2^FILTER_EMA_SHIFT per reading (0 turns it off)
+ * 3. Running variance of the raw readings around that average, as a
+ *    measure of input noise
+ *
+ * Cost per reading is fixed (a median network on a small copy, no data-
+ * dependent loops), so it is safe to run from the ADC interrupt.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Filter state of one input
+struct SampleFilter {
+  uint16_t window[FILTER_MEDIAN_SIZE];   // Last readings (ring)
+  uint8_t next;                          // Ring slot to overwrite
+  uint16_t raw;                          // Latest unfiltered reading
+  uint32_t emaScaled;                    // Average << FILTER_EMA_SHIFT
+  uint32_t variance;                     // Raw variance, reading units squared
+};
+
+// ============================================================================
+// FILTER FUNCTIONS
+// ============================================================================
+
+/**
+ * Start a filter from a known reading (no settling transient)
+ * @param filter: filter state
+ * @param initial: reading to fill the window and average with
+ */
+void filterReset(SampleFilter* filter, uint16_t initial);
+
+/**
+ * Add one reading
+ * @param filter: filter state
+ * @param sample: new raw reading
+ * @return filtered value
+ */
+uint16_t filterAdd(SampleFilter* filter, uint16_t sample);
+
+/**
+ * Get the filtered value (rounded)
+ * @param filter: filter state
+ * @return filtered value
+ */
+uint16_t filterGetValue(const SampleFilter* filter);
+
+/**
+ * Time filterAdd() on a synthetic noisy, spiky input
+ * Runs with interrupts enabled (a few ms in total); the best of several
+ * passes is kept so interrupt time mostly drops out.
+ * Format: "FILTER:BENCH,Median:<n>,EmaShift:<n>,Samples:<n>,PerSample:<us>.<hundredths>us"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* filterGetBenchmarkString(char* buffer, size_t bufferSize);
+
+#endif // FILTER_H
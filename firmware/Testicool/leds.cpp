@@ -0,0 +1,200 @@
+/*
+ * leds.cpp
+ * Non-blocking LED pattern engine implementation for Testicool device
+ *
+ * A step with duration 0 holds its level forever (solid patterns).
+ * Base patterns loop; overlay patterns play `repeats` times.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "leds.h"
+#include "config.h"
+
+#define NO_PIN      0xFF
+#define NO_OVERLAY  0xFF
+
+// ============================================================================
+// PATTERN TABLE (flash)
+// ============================================================================
+
+struct LedStep {
+  uint8_t level;          // HIGH or LOW
+  uint16_t durationMs;    // 0 = hold forever
+};
+
+struct LedPatternDef {
+  const LedStep* steps;
+  uint8_t stepCount;
+  uint8_t repeats;        // Overlay play count (ignored for base patterns)
+};
+
+static const LedStep stepsOff[] PROGMEM      = { { LOW, 0 } };
+static const LedStep stepsOn[] PROGMEM       = { { HIGH, 0 } };
+static const LedStep stepsError[] PROGMEM    = { { HIGH, 200 }, { LOW, 200 } };
+static const LedStep stepsSafety[] PROGMEM   = { { HIGH, 150 }, { LOW, 150 }, { HIGH, 150 }, { LOW, 1000 } };
+static const LedStep stepsOverheat[] PROGMEM = { { HIGH, 150 }, { LOW, 150 }, { HIGH, 150 }, { LOW, 150 },
+                                                 { HIGH, 150 }, { LOW, 1000 } };
+static const LedStep stepsFlash[] PROGMEM    = { { HIGH, 50 } };
+static const LedStep stepsBoot[] PROGMEM     = { { HIGH, 200 }, { LOW, 200 } };
+
+#define PATTERN(steps, repeats)  { steps, sizeof(steps) / sizeof(steps[0]), repeats }
+
+// Indexed by LedPattern
+static const LedPatternDef patternTable[LED_PATTERN_COUNT] PROGMEM = {
+  PATTERN(stepsOff, 1),
+  PATTERN(stepsOn, 1),
+  PATTERN(stepsError, 1),
+  PATTERN(stepsSafety, 1),
+  PATTERN(stepsOverheat, 1),
+  PATTERN(stepsFlash, 1),
+  PATTERN(stepsBoot, 3)
+};
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct LedState {
+  uint8_t pin;
+  uint8_t basePattern;
+  uint8_t overlayPattern;     // NO_OVERLAY when the base is showing
+  uint8_t repeatsLeft;        // Overlay plays remaining (including current)
+  uint8_t step;               // Current step of the active pattern
+  unsigned long stepStartMs;
+};
+
+static LedState leds[LED_ID_COUNT];
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static void readPattern(uint8_t pattern, LedPatternDef* def) {
+  memcpy_P(def, &patternTable[pattern], sizeof(LedPatternDef));
+}
+
+static void readStep(const LedPatternDef& def, uint8_t step, LedStep* out) {
+  memcpy_P(out, &def.steps[step], sizeof(LedStep));
+}
+
+// Output the current step of whichever layer is active
+static void applyStep(LedState& led) {
+  if (led.pin == NO_PIN) {
+    return;
+  }
+
+  LedPatternDef def;
+  readPattern(led.overlayPattern != NO_OVERLAY ? led.overlayPattern : led.basePattern, &def);
+
+  LedStep step;
+  readStep(def, led.step, &step);
+  digitalWrite(led.pin, step.level);
+}
+
+// ============================================================================
+// LED INITIALIZATION
+// ============================================================================
+
+void ledInit() {
+  #ifdef LED_POWER_PIN
+    leds[LED_ID_POWER].pin = LED_POWER_PIN;
+  #else
+    leds[LED_ID_POWER].pin = NO_PIN;
+  #endif
+
+  #ifdef LED_BLUETOOTH_PIN
+    leds[LED_ID_BLUETOOTH].pin = LED_BLUETOOTH_PIN;
+  #else
+    leds[LED_ID_BLUETOOTH].pin = NO_PIN;
+  #endif
+
+  for (uint8_t i = 0; i < LED_ID_COUNT; i++) {
+    leds[i].basePattern = LED_PATTERN_OFF;
+    leds[i].overlayPattern = NO_OVERLAY;
+    leds[i].step = 0;
+    leds[i].stepStartMs = millis();
+    if (leds[i].pin != NO_PIN) {
+      pinMode(leds[i].pin, OUTPUT);
+      digitalWrite(leds[i].pin, LOW);
+    }
+  }
+}
+
+// ============================================================================
+// PATTERN REQUESTS
+// ============================================================================
+
+void ledSetBase(LedId led, LedPattern pattern) {
+  if (led >= LED_ID_COUNT || pattern >= LED_PATTERN_COUNT) {
+    return;
+  }
+
+  LedState& state = leds[led];
+  if (state.basePattern == pattern) {
+    return;  // Already looping - do not restart
+  }
+
+  state.basePattern = pattern;
+  if (state.overlayPattern == NO_OVERLAY) {
+    state.step = 0;
+    state.stepStartMs = millis();
+    applyStep(state);
+  }
+}
+
+void ledPlay(LedId led, LedPattern pattern) {
+  if (led >= LED_ID_COUNT || pattern >= LED_PATTERN_COUNT) {
+    return;
+  }
+
+  LedPatternDef def;
+  readPattern(pattern, &def);
+
+  LedState& state = leds[led];
+  state.overlayPattern = pattern;
+  state.repeatsLeft = def.repeats;
+  state.step = 0;
+  state.stepStartMs = millis();
+  applyStep(state);
+}
+
+// ============================================================================
+// PATTERN ENGINE
+// ============================================================================
+
+void ledUpdate() {
+  unsigned long now = millis();
+
+  for (uint8_t i = 0; i < LED_ID_COUNT; i++) {
+    LedState& state = leds[i];
+    bool overlay = (state.overlayPattern != NO_OVERLAY);
+
+    LedPatternDef def;
+    readPattern(overlay ? state.overlayPattern : state.basePattern, &def);
+
+    LedStep step;
+    readStep(def, state.step, &step);
+
+    if (step.durationMs == 0 || now - state.stepStartMs < step.durationMs) {
+      continue;  // Holding, or current step not finished
+    }
+
+    // Advance to the next step
+    state.stepStartMs += step.durationMs;
+    if (now - state.stepStartMs >= step.durationMs) {
+      state.stepStartMs = now;  // Far behind (long stall) - resync
+    }
+
+    if (++state.step >= def.stepCount) {
+      state.step = 0;
+
+      // Overlay finished all its plays - fall back to the base pattern
+      if (overlay && --state.repeatsLeft == 0) {
+        state.overlayPattern = NO_OVERLAY;
+      }
+    }
+
+    applyStep(state);
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * leds.h
+ * Non-blocking LED pattern engine header for Testicool device
+ *
+ * Patterns are tables of (level, duration) steps stored in flash. Each
+ * LED has two layers:
+ * - Base pattern: loops forever (solid on, off, error blink codes)
+ * - Overlay pattern: plays a fixed number of times on top of the base
+ *   (command flash, boot animation), then the base resumes
+ *
+ * ledUpdate() advances all LEDs from the scheduler LED task and never
+ * blocks, so command handling is no longer tied to LED timing.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef LEDS_H
+#define LEDS_H
+
+#include <Arduino.h>
+
+// Status LEDs
+enum LedId {
+  LED_ID_POWER = 0,       // LED_POWER_PIN
+  LED_ID_BLUETOOTH = 1,   // LED_BLUETOOTH_PIN (onboard LED)
+  LED_ID_COUNT
+};
+
+// Patterns (see the table in leds.cpp)
+enum LedPattern {
+  LED_PATTERN_OFF = 0,        // Solid off
+  LED_PATTERN_ON,             // Solid on
+  LED_PATTERN_ERROR,          // Fast blink 200/200 ms (generic pump error)
+  LED_PATTERN_SAFETY,         // Blink code: 2 short blinks, pause (max runtime shutoff)
+  LED_PATTERN_OVERHEAT,       // Blink code: 3 short blinks, pause (skin overheat)
+  LED_PATTERN_FLASH,          // One 50 ms flash (command received)
+  LED_PATTERN_BOOT,           // 3 blinks 200/200 ms (startup)
+  LED_PATTERN_COUNT
+};
+
+// ============================================================================
+// LED FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize LED pins (all off, base pattern OFF)
+ * Call this function once in setup()
+ */
+void ledInit();
+
+/**
+ * Set the looping base pattern of an LED
+ * Does nothing if the pattern is already active, so it can be called
+ * every update without restarting the pattern
+ * @param led: LED to change
+ * @param pattern: pattern to loop
+ */
+void ledSetBase(LedId led, LedPattern pattern);
+
+/**
+ * Play a pattern once on top of the base pattern
+ * Starts immediately and replaces any overlay already playing
+ * @param led: LED to change
+ * @param pattern: pattern to play
+ */
+void ledPlay(LedId led, LedPattern pattern);
+
+/**
+ * Advance all LED patterns and update the pins
+ * Called from the scheduler LED task every LED_UPDATE_INTERVAL_MS
+ */
+void ledUpdate();
+
+#endif // LEDS_H
@@ -0,0 +1,143 @@
+/*
+ * perf.cpp
+ * Built-in execution-time profiler implementation for Testicool device
+ *
+ * RAM cost: 14 bytes per stage plus the busy-time counters.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "perf.h"
+
+#if PERF_ENABLED
+
+// ============================================================================
+// STAGE NAMES (flash)
+// ============================================================================
+
+static const char nameButtons[] PROGMEM   = "BTN";
+static const char nameCommands[] PROGMEM  = "CMD";
+static const char nameSafety[] PROGMEM    = "SAFETY";
+static const char nameTemp[] PROGMEM      = "TEMP";
+static const char namePot[] PROGMEM       = "POT";
+static const char nameStatus[] PROGMEM    = "STATUS";
+static const char nameLeds[] PROGMEM      = "LED";
+static const char nameBtProcess[] PROGMEM = "bt.process";
+static const char nameBtCommand[] PROGMEM = "bt.command";
+static const char nameBtStatus[] PROGMEM  = "bt.sendStatus";
+static const char nameBtWrite[] PROGMEM   = "bt.write";
+static const char nameTempConv[] PROGMEM  = "temp.convert";
+static const char namePumpSafe[] PROGMEM  = "pump.safety";
+static const char namePumpStat[] PROGMEM  = "pump.status";
+
+// Indexed by PerfStage
+static const char* const stageNames[PERF_STAGE_COUNT] PROGMEM = {
+  nameButtons, nameCommands, nameSafety, nameTemp, namePot, nameStatus, nameLeds,
+  nameBtProcess, nameBtCommand, nameBtStatus, nameBtWrite, nameTempConv, namePumpSafe, namePumpStat
+};
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct StageStats {
+  unsigned long count;
+  unsigned long sumUs;
+  unsigned long maxUs;
+  uint16_t minUs;          // Saturates at 65535
+};
+
+static StageStats stages[PERF_STAGE_COUNT];
+
+static unsigned long windowStartMs = 0;
+static unsigned long busyMs = 0;
+static unsigned int busyRemainderUs = 0;
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+void perfRecord(uint8_t stage, unsigned long durationUs) {
+  if (stage >= PERF_STAGE_COUNT) {
+    return;
+  }
+
+  StageStats& s = stages[stage];
+  uint16_t shortDuration = durationUs > 0xFFFFUL ? 0xFFFF : (uint16_t)durationUs;
+
+  if (s.count == 0 || shortDuration < s.minUs) {
+    s.minUs = shortDuration;
+  }
+  if (durationUs > s.maxUs) {
+    s.maxUs = durationUs;
+  }
+  s.sumUs += durationUs;
+  s.count++;
+
+  // Loop stages are top-level, so their sum is the CPU busy time
+  if (stage < PERF_LOOP_COUNT) {
+    unsigned long total = durationUs + busyRemainderUs;
+    busyMs += total / 1000UL;
+    busyRemainderUs = total % 1000UL;
+  }
+}
+
+void perfGetStats(uint8_t stage, PerfStats* stats) {
+  if (stage >= PERF_STAGE_COUNT || stats == NULL) {
+    return;
+  }
+
+  const StageStats& s = stages[stage];
+  stats->count = s.count;
+  stats->minUs = s.minUs;
+  stats->meanUs = s.count ? s.sumUs / s.count : 0;
+  stats->maxUs = s.maxUs;
+}
+
+void perfReset() {
+  memset(stages, 0, sizeof(stages));
+  busyMs = 0;
+  busyRemainderUs = 0;
+  windowStartMs = millis();
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* perfGetSummaryString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 40) {
+    return NULL;
+  }
+
+  unsigned long windowMs = millis() - windowStartMs;
+  // 64-bit product: busyMs * 1000 passes 2^32 after ~71 min of busy time
+  unsigned long permille = windowMs ? (unsigned long)((uint64_t)busyMs * 1000 / windowMs) : 0;
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("PERF:{Busy:%lu.%lu%%,WindowMs:%lu}"),
+             permille / 10, permille % 10, windowMs);
+
+  return buffer;
+}
+
+char* perfGetStageString(uint8_t stage, char* buffer, size_t bufferSize) {
+  if (stage >= PERF_STAGE_COUNT || buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  char name[16];
+  strncpy_P(name, (const char*)pgm_read_ptr(&stageNames[stage]), sizeof(name) - 1);
+  name[sizeof(name) - 1] = '\0';
+
+  PerfStats stats;
+  perfGetStats(stage, &stats);
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("PERF:%s,N:%lu,Min:%lu,Mean:%lu,Max:%luus"),
+             name, stats.count, stats.minUs, stats.meanUs, stats.maxUs);
+
+  return buffer;
+}
+
+#endif // PERF_ENABLED
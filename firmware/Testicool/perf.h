@@ -0,0 +1,122 @@
+/*
+ * perf.h
+ * Built-in execution-time profiler header for Testicool device
+ *
+ * Put PERF_SCOPE(stage) at the top of a function or block; the time until
+ * the end of that scope is measured with micros() and folded into running
+ * count/min/mean/max statistics for the stage.
+ *
+ * Loop stages (the scheduler tasks) also add up to the CPU busy time,
+ * reported as a percentage of wall time. Function stages are nested
+ * inside loop stages and do not count twice.
+ *
+ * micros() has 4 us resolution on a 16 MHz Nano and each measurement
+ * costs a few microseconds, so very short stages read high.
+ *
+ * With PERF_ENABLED false in config.h, PERF_SCOPE() expands to nothing
+ * and the profiler (and the PERF command) compile out completely.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Profiled stages
+enum PerfStage {
+  // Loop stages (one per scheduler task) - count toward CPU busy time
+  PERF_LOOP_BUTTONS = 0,
+  PERF_LOOP_COMMANDS,
+  PERF_LOOP_SAFETY,
+  PERF_LOOP_TEMPERATURE,
+  PERF_LOOP_SPEED_POT,
+  PERF_LOOP_STATUS,
+  PERF_LOOP_LEDS,
+  PERF_LOOP_COUNT,
+
+  // Functions called from the loop stages
+  PERF_BT_PROCESS = PERF_LOOP_COUNT,  // bluetoothProcessCommands()
+  PERF_BT_COMMAND,                    // Parsing and executing one command
+  PERF_BT_SEND_STATUS,                // bluetoothSendStatus() formatting + output
+  PERF_BT_WRITE,                      // Queueing one output line
+  PERF_TEMP_CONVERT,                  // Thermistor ADC -> temperature conversion
+  PERF_PUMP_SAFETY,                   // pumpCheckSafety()
+  PERF_PUMP_STATUS,                   // pumpGetStatusString()
+  PERF_STAGE_COUNT
+};
+
+#if PERF_ENABLED
+
+// Statistics of one stage
+struct PerfStats {
+  unsigned long count;   // Number of measurements
+  unsigned long minUs;   // Shortest
+  unsigned long meanUs;  // Mean
+  unsigned long maxUs;   // Longest
+};
+
+// ============================================================================
+// PROFILER FUNCTIONS
+// ============================================================================
+
+/**
+ * Add one measurement to a stage
+ * @param stage: PerfStage being measured
+ * @param durationUs: elapsed time in microseconds
+ */
+void perfRecord(uint8_t stage, unsigned long durationUs);
+
+/**
+ * Get statistics of one stage
+ * @param stage: PerfStage
+ * @param stats: structure to fill
+ */
+void perfGetStats(uint8_t stage, PerfStats* stats);
+
+/**
+ * Clear all statistics and restart the busy-time window
+ */
+void perfReset();
+
+/**
+ * Format the CPU busy summary
+ * Format: "PERF:{Busy:<pct>.<tenth>%,WindowMs:<ms>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* perfGetSummaryString(char* buffer, size_t bufferSize);
+
+/**
+ * Format statistics of one stage
+ * Format: "PERF:<name>,N:<count>,Min:<us>,Mean:<us>,Max:<us>us"
+ * @param stage: PerfStage
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer, NULL if stage is out of range
+ */
+char* perfGetStageString(uint8_t stage, char* buffer, size_t bufferSize);
+
+// Measures from construction to end of scope
+class PerfScope {
+ public:
+  explicit PerfScope(uint8_t stage) : stageId(stage), startUs(micros()) {}
+  ~PerfScope() { perfRecord(stageId, micros() - startUs); }
+
+ private:
+  uint8_t stageId;
+  unsigned long startUs;
+};
+
+#define PERF_SCOPE(stage)  PerfScope perfScope(stage)
+
+#else
+
+#define PERF_SCOPE(stage)
+
+#endif // PERF_ENABLED
+
+#endif // PERF_H
@@ -0,0 +1,132 @@
+/*
+ * power.cpp
+ * Tickless idle / power management implementation for Testicool device
+ *
+ * Uses the standard race-free sleep sequence: the wake check runs with
+ * interrupts disabled, and "sei; sleep" executes atomically, so an
+ * interrupt arriving between the check and the sleep instruction still
+ * wakes the CPU immediately.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "power.h"
+#include "config.h"
+#include "uart.h"
+#include <avr/sleep.h>
+#include <avr/power.h>
+
+// Mode reported by POWER (fixed at compile time)
+#if IDLE_SLEEP_ENABLED
+  #define SLEEP_MODE_NAME  "IDLE"
+#else
+  #define SLEEP_MODE_NAME  "OFF"
+#endif
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static unsigned long windowStartMs = 0;
+static unsigned long asleepMs = 0;
+static unsigned int asleepRemainderUs = 0;   // Sub-millisecond part of asleepMs
+static unsigned long sleepCount = 0;
+static unsigned long wakeupCount = 0;
+
+// ============================================================================
+// POWER MANAGEMENT INITIALIZATION
+// ============================================================================
+
+void powerInit() {
+  // Peripherals this device never uses
+  power_twi_disable();
+  power_spi_disable();
+
+  powerResetStats();
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.println(F("[POWER] Initialized - Idle sleep between deadlines"));
+  #endif
+}
+
+// ============================================================================
+// IDLE SLEEP
+// ============================================================================
+
+void powerIdle(unsigned long idleUs, bool (*wakeCheck)()) {
+  #if IDLE_SLEEP_ENABLED
+    if (idleUs < IDLE_MIN_SLEEP_US) {
+      return;  // Not worth the wake-up overhead
+    }
+
+    unsigned long start = micros();
+    sleepCount++;
+    set_sleep_mode(SLEEP_MODE_IDLE);
+
+    while (true) {
+      cli();
+      if ((micros() - start) >= idleUs || (wakeCheck != NULL && wakeCheck())) {
+        sei();
+        break;
+      }
+      sleep_enable();
+      sei();          // Executes atomically with the next instruction
+      sleep_cpu();    // Any interrupt wakes us here
+      sleep_disable();
+      wakeupCount++;
+    }
+
+    // Accumulate time asleep in ms, carrying the sub-ms remainder
+    unsigned long sleptUs = micros() - start + asleepRemainderUs;
+    asleepMs += sleptUs / 1000UL;
+    asleepRemainderUs = sleptUs % 1000UL;
+  #else
+    (void)idleUs;
+    (void)wakeCheck;
+  #endif
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void powerGetStats(PowerStats* stats) {
+  if (stats == NULL) {
+    return;
+  }
+
+  stats->windowMs = millis() - windowStartMs;
+  stats->asleepMs = asleepMs;
+  stats->sleeps = sleepCount;
+  stats->wakeups = wakeupCount;
+}
+
+void powerResetStats() {
+  windowStartMs = millis();
+  asleepMs = 0;
+  asleepRemainderUs = 0;
+  sleepCount = 0;
+  wakeupCount = 0;
+}
+
+char* powerGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  PowerStats stats;
+  powerGetStats(&stats);
+
+  // 64-bit product: asleepMs * 100 passes 2^32 after ~12 h asleep
+  unsigned int asleepPct = stats.windowMs ? (unsigned int)((uint64_t)stats.asleepMs * 100 / stats.windowMs) : 0;
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("POWER:{Mode:" SLEEP_MODE_NAME ",Asleep:%u%%,SleepMs:%lu,WindowMs:%lu,Sleeps:%lu,Wakes:%lu}"),
+             asleepPct,
+             stats.asleepMs,
+             stats.windowMs,
+             stats.sleeps,
+             stats.wakeups);
+
+  return buffer;
+}
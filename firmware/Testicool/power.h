@@ -0,0 +1,77 @@
+/*
+ * power.h
+ * Tickless idle / power management header for Testicool device
+ *
+ * Instead of spinning in loop() between tasks, the CPU sleeps until the
+ * next scheduler deadline. Any interrupt (UART RX, button, control tick,
+ * millis timer) wakes it; the wake check decides whether to return early
+ * or go back to sleep until the deadline.
+ *
+ * Sleep mode is IDLE: the CPU clock stops but Timer0 (millis), Timer1
+ * (pump PWM), Timer2 (control tick), the ADC and the UART keep running.
+ * The deeper power-save mode is not usable on the Nano: Timer2 only runs
+ * in power-save when clocked from a 32 kHz watch crystal on TOSC1/2
+ * (those pins carry the 16 MHz crystal), the UART cannot wake the CPU
+ * from it, and INT0 could only wake on a level, not an edge.
+ *
+ * Time spent asleep is accumulated so the POWER command can show the
+ * duty cycle of the CPU.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+// Sleep statistics since boot or POWER:RESET
+struct PowerStats {
+  unsigned long windowMs;    // Length of the measurement window
+  unsigned long asleepMs;    // Time spent in sleep mode
+  unsigned long sleeps;      // Number of idle periods entered
+  unsigned long wakeups;     // Number of interrupt wakeups while idle
+};
+
+// ============================================================================
+// POWER MANAGEMENT FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize power management
+ * Turns off unused peripherals (TWI, SPI) and starts the statistics window
+ * Call this function once in setup()
+ */
+void powerInit();
+
+/**
+ * Sleep until a deadline or until an early wake is requested
+ * Returns immediately if the idle time is too short to be worth sleeping
+ * (IDLE_MIN_SLEEP_US) or if IDLE_SLEEP_ENABLED is false.
+ * @param idleUs: microseconds until the next scheduled deadline
+ * @param wakeCheck: called after every interrupt wakeup with interrupts
+ *                   disabled; return true to stop sleeping early
+ */
+void powerIdle(unsigned long idleUs, bool (*wakeCheck)());
+
+/**
+ * Get sleep statistics
+ * @param stats: structure to fill
+ */
+void powerGetStats(PowerStats* stats);
+
+/**
+ * Restart the sleep statistics window
+ */
+void powerResetStats();
+
+/**
+ * Format sleep statistics
+ * Format: "POWER:{Mode:IDLE,Asleep:<pct>%,SleepMs:<ms>,WindowMs:<ms>,Sleeps:<n>,Wakes:<n>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* powerGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // POWER_H
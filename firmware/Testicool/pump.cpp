@@ -9,6 +9,12 @@
 
 #include "pump.h"
 #include "config.h"
+#include "uart.h"
+#include "perf.h"
+#include "supply.h"
+#include "feedforward.h"
+#include "pumppwm.h"
+#include "samplerate.h"
 
 // ============================================================================
 // PRIVATE STATE VARIABLES
@@ -16,28 +22,48 @@
 
 static PumpState currentState = PUMP_OFF;
 static uint8_t currentSpeed = 0;
+static uint16_t currentLevel = 0;     // currentSpeed in 0-PUMP_HIRES_MAX, or as set by pumpSetSpeedHiRes()
+static uint16_t currentDuty = 0;      // PWM level actually written (after feedforward and supply compensation)
 static unsigned long pumpStartTime = 0;
-static unsigned long lastSafetyCheck = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+// Duty for a level: scaled for the water temperature, then for the measured pump supply
+static uint16_t dutyFor(uint16_t level) {
+  return supplyCompensateDuty(feedforwardApply(level));
+}
+
+// Write the PWM for a level
+static void writeLevel(uint16_t level) {
+  currentDuty = dutyFor(level);
+  pumpPwmWrite(currentDuty);
+}
 
 // ============================================================================
 // PUMP INITIALIZATION
 // ============================================================================
 
 void pumpInit() {
-  // Configure pump control pins
-  pinMode(PUMP_PWM_PIN, OUTPUT);
+  // Latch LOW before switching the pins to outputs, so the driver never
+  // sees a glitch between reset (pins floating) and the OFF state
+  digitalWrite(PUMP_ENABLE_PIN, LOW);
+  digitalWrite(PUMP_PWM_PIN, LOW);
   pinMode(PUMP_ENABLE_PIN, OUTPUT);
+  pinMode(PUMP_PWM_PIN, OUTPUT);
 
-  // Initialize pump to OFF state
-  digitalWrite(PUMP_ENABLE_PIN, LOW);
-  analogWrite(PUMP_PWM_PIN, 0);
+  // Timer1 takes the PWM over from analogWrite(), output still LOW
+  pumpPwmInit();
 
   currentState = PUMP_OFF;
   currentSpeed = 0;
+  currentLevel = 0;
+  currentDuty = 0;
   pumpStartTime = 0;
 
   #if DEBUG_MODE
-    Serial.println(F("[PUMP] Initialized - State: OFF"));
+    DEBUG_SERIAL.println(F("[PUMP] Initialized - State: OFF"));
   #endif
 }
 
@@ -57,26 +83,30 @@ bool pumpOn(uint8_t speed) {
   // Check if already in error state
   if (currentState == PUMP_ERROR) {
     #if DEBUG_MODE
-      Serial.println(F("[PUMP] ERROR: Cannot start pump - error state active"));
+      DEBUG_SERIAL.println(F("[PUMP] ERROR: Cannot start pump - error state active"));
     #endif
     return false;
   }
 
   // Enable pump
   digitalWrite(PUMP_ENABLE_PIN, HIGH);
-  analogWrite(PUMP_PWM_PIN, speed);
+  currentLevel = SPEED_TO_HIRES(speed);
+  writeLevel(currentLevel);
 
   // Update state
   currentState = PUMP_ON;
   currentSpeed = speed;
   pumpStartTime = millis();
 
+  // Pot and thermostat need the full control rate from now on
+  sampleRatePumpStarted();
+
   #if DEBUG_MODE
-    Serial.print(F("[PUMP] Started - Speed: "));
-    Serial.print(speed);
-    Serial.print(F(" ("));
-    Serial.print((speed * 100) / 255);
-    Serial.println(F("%)"));
+    DEBUG_SERIAL.print(F("[PUMP] Started - Speed: "));
+    DEBUG_SERIAL.print(speed);
+    DEBUG_SERIAL.print(F(" ("));
+    DEBUG_SERIAL.print((speed * 100) / 255);
+    DEBUG_SERIAL.println(F("%)"));
   #endif
 
   return true;
@@ -85,15 +115,17 @@ bool pumpOn(uint8_t speed) {
 void pumpOff() {
   // Disable pump
   digitalWrite(PUMP_ENABLE_PIN, LOW);
-  analogWrite(PUMP_PWM_PIN, 0);
+  pumpPwmWrite(0);
 
   // Update state
   currentState = PUMP_OFF;
   currentSpeed = 0;
+  currentLevel = 0;
+  currentDuty = 0;
   pumpStartTime = 0;
 
   #if DEBUG_MODE
-    Serial.println(F("[PUMP] Stopped"));
+    DEBUG_SERIAL.println(F("[PUMP] Stopped"));
   #endif
 }
 
@@ -101,7 +133,7 @@ bool pumpSetSpeed(uint8_t speed) {
   // Check if pump is running
   if (currentState != PUMP_ON) {
     #if DEBUG_MODE
-      Serial.println(F("[PUMP] ERROR: Cannot set speed - pump is not running"));
+      DEBUG_SERIAL.println(F("[PUMP] ERROR: Cannot set speed - pump is not running"));
     #endif
     return false;
   }
@@ -110,24 +142,70 @@ bool pumpSetSpeed(uint8_t speed) {
   speed = constrain(speed, PUMP_MIN_SPEED, PUMP_MAX_SPEED);
 
   // Update PWM
-  analogWrite(PUMP_PWM_PIN, speed);
+  currentLevel = SPEED_TO_HIRES(speed);
+  writeLevel(currentLevel);
   currentSpeed = speed;
 
   #if DEBUG_MODE
-    Serial.print(F("[PUMP] Speed changed to: "));
-    Serial.print(speed);
-    Serial.print(F(" ("));
-    Serial.print((speed * 100) / 255);
-    Serial.println(F("%)"));
+    DEBUG_SERIAL.print(F("[PUMP] Speed changed to: "));
+    DEBUG_SERIAL.print(speed);
+    DEBUG_SERIAL.print(F(" ("));
+    DEBUG_SERIAL.print((speed * 100) / 255);
+    DEBUG_SERIAL.println(F("%)"));
   #endif
 
   return true;
 }
 
+bool pumpSetSpeedHiRes(uint16_t level) {
+  if (currentState != PUMP_ON) {
+    #if DEBUG_MODE
+      DEBUG_SERIAL.println(F("[PUMP] ERROR: Cannot set speed - pump is not running"));
+    #endif
+    return false;
+  }
+
+  currentLevel = min(level, SPEED_TO_HIRES(PUMP_MAX_SPEED));
+  writeLevel(currentLevel);
+  currentSpeed = HIRES_TO_SPEED(currentLevel);
+  return true;
+}
+
 uint8_t pumpGetSpeed() {
   return currentSpeed;
 }
 
+uint16_t pumpGetSpeedHiRes() {
+  return currentLevel;
+}
+
+uint8_t pumpGetDuty() {
+  return HIRES_TO_SPEED(currentDuty);
+}
+
+uint16_t pumpGetDutyHiRes() {
+  return currentDuty;
+}
+
+void pumpRefreshDuty() {
+  if (currentState != PUMP_ON) {
+    return;
+  }
+
+  uint16_t duty = dutyFor(currentLevel);
+  if (duty != currentDuty) {
+    currentDuty = duty;
+    pumpPwmWrite(duty);
+
+    #if DEBUG_MODE
+      DEBUG_SERIAL.print(F("[PUMP] Speed "));
+      DEBUG_SERIAL.print(currentSpeed);
+      DEBUG_SERIAL.print(F(" - duty "));
+      DEBUG_SERIAL.println(duty);
+    #endif
+  }
+}
+
 PumpState pumpGetState() {
   return currentState;
 }
@@ -158,27 +236,22 @@ unsigned long pumpGetRemainingTime() {
 // ============================================================================
 
 bool pumpCheckSafety() {
+  PERF_SCOPE(PERF_PUMP_SAFETY);
+
   // Only check if pump is running
   if (currentState != PUMP_ON) {
     return false;
   }
 
-  // Throttle safety checks to avoid excessive checking
-  unsigned long currentTime = millis();
-  if (currentTime - lastSafetyCheck < 1000) {  // Check once per second
-    return false;
-  }
-  lastSafetyCheck = currentTime;
-
   // Check maximum runtime
   unsigned long runtime = pumpGetRuntime();
 
   if (runtime >= MAX_RUN_TIME_MS) {
     #if DEBUG_MODE
-      Serial.println(F("[PUMP] SAFETY: Maximum runtime exceeded - auto-stopping"));
-      Serial.print(F("[PUMP] Runtime: "));
-      Serial.print(runtime / 60000);
-      Serial.println(F(" minutes"));
+      DEBUG_SERIAL.println(F("[PUMP] SAFETY: Maximum runtime exceeded - auto-stopping"));
+      DEBUG_SERIAL.print(F("[PUMP] Runtime: "));
+      DEBUG_SERIAL.print(runtime / 60000);
+      DEBUG_SERIAL.println(F(" minutes"));
     #endif
 
     pumpOff();
@@ -199,23 +272,30 @@ void pumpResetError() {
     currentState = PUMP_OFF;
 
     #if DEBUG_MODE
-      Serial.println(F("[PUMP] Error state cleared"));
+      DEBUG_SERIAL.println(F("[PUMP] Error state cleared"));
     #endif
   }
 }
 
 void pumpEmergencyStop() {
   #if DEBUG_MODE
-    Serial.println(F("[PUMP] EMERGENCY STOP ACTIVATED"));
+    DEBUG_SERIAL.println(F("[PUMP] EMERGENCY STOP ACTIVATED"));
   #endif
 
   // Immediate hardware shutoff
   digitalWrite(PUMP_ENABLE_PIN, LOW);
-  analogWrite(PUMP_PWM_PIN, 0);
+  pumpPwmForceOff();
 
   // Set error state
   currentState = PUMP_ERROR;
   currentSpeed = 0;
+  currentLevel = 0;
+  currentDuty = 0;
+}
+
+void pumpForceSafe() {
+  digitalWrite(PUMP_ENABLE_PIN, LOW);
+  pumpPwmForceOff();
 }
 
 // ============================================================================
@@ -223,37 +303,41 @@ void pumpEmergencyStop() {
 // ============================================================================
 
 char* pumpGetStatusString(char* buffer, size_t bufferSize) {
+  PERF_SCOPE(PERF_PUMP_STATUS);
+
   if (buffer == NULL || bufferSize < 50) {
     return NULL;
   }
 
-  const char* stateStr;
+  PGM_P stateName;
   switch (currentState) {
     case PUMP_OFF:
-      stateStr = "OFF";
+      stateName = PSTR("OFF");
       break;
     case PUMP_ON:
-      stateStr = "ON";
+      stateName = PSTR("ON");
       break;
     case PUMP_ERROR:
-      stateStr = "ERROR";
+      stateName = PSTR("ERROR");
       break;
     default:
-      stateStr = "UNKNOWN";
+      stateName = PSTR("UNKNOWN");
   }
+  char stateStr[8];
+  strcpy_P(stateStr, stateName);
 
   if (currentState == PUMP_ON) {
     unsigned long runtime = pumpGetRuntime();
     unsigned long remainingTime = pumpGetRemainingTime();
 
-    snprintf(buffer, bufferSize,
-             "State:%s,Speed:%d%%,Runtime:%lum,Remaining:%lum",
-             stateStr,
-             (currentSpeed * 100) / 255,
-             runtime / 60000,
-             remainingTime / 60000);
+    snprintf_P(buffer, bufferSize,
+               PSTR("State:%s,Speed:%d%%,Runtime:%lum,Remaining:%lum"),
+               stateStr,
+               (currentSpeed * 100) / 255,
+               runtime / 60000,
+               remainingTime / 60000);
   } else {
-    snprintf(buffer, bufferSize, "State:%s", stateStr);
+    snprintf_P(buffer, bufferSize, PSTR("State:%s"), stateStr);
   }
 
   return buffer;
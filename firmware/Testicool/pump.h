@@ -30,13 +30,15 @@ enum PumpState {
 
 /**
  * Initialize pump hardware and set default state
- * Configures PWM pins, enable pins, and sets pump to OFF
+ * Configures PWM pins, enable pins, Timer1 (pumppwm.h), and sets pump to OFF
  * Call this function once in setup()
  */
 void pumpInit();
 
 /**
  * Turn pump ON at specified speed
+ * The duty written is scaled for the water temperature (see feedforward.h)
+ * and compensated for the pump supply (see supply.h)
  * @param speed: PWM value 0-255 (default uses PUMP_DEFAULT_SPEED from config.h)
  * @return true if pump started successfully, false if error
  */
@@ -55,12 +57,50 @@ void pumpOff();
  */
 bool pumpSetSpeed(uint8_t speed);
 
+/**
+ * Set pump speed while running, in finer steps than pumpSetSpeed()
+ * The PWM has PUMP_PWM_HZ-dependent resolution (800 steps at 20 kHz),
+ * about three times finer than 0-255 (see pumppwm.h)
+ * @param level: 0-PUMP_HIRES_MAX (SPEED_TO_HIRES() converts a 0-255 speed)
+ * @return true if speed was set, false if pump is off or error
+ */
+bool pumpSetSpeedHiRes(uint16_t level);
+
 /**
  * Get current pump speed
- * @return current PWM value (0-255), 0 if pump is off
+ * @return current PWM value (0-255, rounded after pumpSetSpeedHiRes()),
+ *         0 if pump is off
  */
 uint8_t pumpGetSpeed();
 
+/**
+ * Get current pump speed at full resolution
+ * @return 0-PUMP_HIRES_MAX, 0 if pump is off
+ */
+uint16_t pumpGetSpeedHiRes();
+
+/**
+ * Get the PWM duty actually applied
+ * Differs from the speed by the water feedforward and the supply
+ * compensation (see feedforward.h, supply.h)
+ * @return PWM value (0-255, rounded), 0 if pump is off
+ */
+uint8_t pumpGetDuty();
+
+/**
+ * Get the PWM duty actually applied at full resolution
+ * @return 0-PUMP_HIRES_MAX, 0 if pump is off
+ */
+uint16_t pumpGetDutyHiRes();
+
+/**
+ * Rescale the running pump's duty for the latest feedforward scale and
+ * pump supply measurement
+ * Called by the POT task after feedforwardUpdate() and by the SAFETY task
+ * after supplyUpdate()
+ */
+void pumpRefreshDuty();
+
 /**
  * Get current pump state
  * @return PumpState enum value (PUMP_OFF, PUMP_ON, PUMP_ERROR)
@@ -82,7 +122,7 @@ unsigned long pumpGetRemainingTime();
 /**
  * Check if pump has exceeded maximum runtime
  * Automatically shuts off pump if MAX_RUN_TIME_MS is exceeded
- * Call this function regularly in loop()
+ * Called by the scheduler every SAFETY_CHECK_INTERVAL_MS
  * @return true if pump was auto-stopped due to timeout
  */
 bool pumpCheckSafety();
@@ -99,6 +139,12 @@ void pumpResetError();
  */
 void pumpEmergencyStop();
 
+/**
+ * Force the pump driver outputs OFF without touching any other state
+ * Safe to call from interrupt handlers (used by the watchdog interrupt)
+ */
+void pumpForceSafe();
+
 /**
  * Get pump status as formatted string
  * @param buffer: character array to store status string
@@ -0,0 +1,74 @@
+/*
+ * pumppwm.cpp
+ * Timer1 pump PWM implementation for Testicool device
+ *
+ * Timer1 setup: fast PWM with TOP = ICR1 (WGM13:10 = 1110), clk/1,
+ * OC1A cleared on compare match, set at BOTTOM
+ *   16 MHz / 20 kHz = 800 counts -> ICR1 = 799
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "pumppwm.h"
+#include "config.h"
+#include "uart.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// TIMING CONSTANTS
+// ============================================================================
+
+#define PWM_TOP             (F_CPU / PUMP_PWM_HZ - 1)
+
+static_assert(PUMP_PWM_PIN == 9, "The Timer1 pump PWM drives OC1A, which is D9");
+static_assert(PWM_TOP >= 255 && PWM_TOP <= 0xFFFF,
+              "PUMP_PWM_HZ must give 256 to 65536 timer steps (F_CPU / 65536 to F_CPU / 256)");
+
+// ============================================================================
+// PUMP PWM
+// ============================================================================
+
+void pumpPwmInit() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR1B = 0;                          // Stop the timer while it is set up
+    TCCR1A = _BV(WGM11);                 // Fast PWM, TOP = ICR1; OC1A disconnected
+    ICR1 = PWM_TOP;
+    OCR1A = 0;
+    TCNT1 = 0;
+    TIMSK1 = 0;                          // No Timer1 interrupts
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10);  // clk/1
+  }
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[PWM] Timer1 pump PWM - "));
+    DEBUG_SERIAL.print(PUMP_PWM_HZ);
+    DEBUG_SERIAL.print(F(" Hz, "));
+    DEBUG_SERIAL.print(pumpPwmGetSteps());
+    DEBUG_SERIAL.println(F(" steps"));
+  #endif
+}
+
+void pumpPwmWrite(uint16_t level) {
+  if (level == 0) {
+    pumpPwmForceOff();
+    return;
+  }
+
+  level = min(level, (uint16_t)PUMP_HIRES_MAX);
+  uint16_t compare = (uint16_t)(((uint32_t)level * PWM_TOP + PUMP_HIRES_MAX / 2) / PUMP_HIRES_MAX);
+
+  // OCR1A is written through the shared TEMP byte: keep interrupts out
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    OCR1A = compare;
+    TCCR1A = _BV(COM1A1) | _BV(WGM11);   // Non-inverting on OC1A
+  }
+}
+
+void pumpPwmForceOff() {
+  TCCR1A = _BV(WGM11);                   // Pin back to PORTB, which is LOW
+  PORTB &= ~_BV(PORTB1);
+}
+
+uint16_t pumpPwmGetSteps() {
+  return (uint16_t)(PWM_TOP + 1);
+}
@@ -0,0 +1,63 @@
+/*
+ * pumppwm.h
+ * Timer1 pump PWM header for Testicool device
+ *
+ * analogWrite() on D9 runs Timer1 at 8 bits and about 490 Hz: audible as
+ * a whine through the pump, and only 255 steps where a few duty units
+ * decide whether it stalls. The pump drive takes Timer1 over instead:
+ *
+ *   Fast PWM, TOP = ICR1 (mode 14), no prescaler, non-inverting on OC1A
+ *   ICR1 = F_CPU / PUMP_PWM_HZ - 1 = 799 -> 20 kHz, 800 duty steps
+ *
+ * Fast rather than phase-correct PWM: at 16 MHz phase-correct mode only
+ * has 400 steps at 20 kHz, and 10 bits would need ICR1 = 1023, i.e.
+ * 7.8 kHz, which is audible again. Symmetric pulses bring nothing to one
+ * DC motor, so fast PWM with twice the steps is the better trade. OCR1A
+ * is double-buffered, so a new duty starts with the next period.
+ *
+ * Levels are 0-PUMP_HIRES_MAX (10-bit) whatever PUMP_PWM_HZ gives, and
+ * are scaled to the timer steps on write. At level 0 the pin is
+ * disconnected from the timer and held LOW, since OCR1A = 0 would still
+ * leave a one-clock spike every period; at PUMP_HIRES_MAX it is high
+ * throughout.
+ *
+ * D9 is fixed (OC1A); analogWrite() on D10 (OC1B) would reconfigure
+ * Timer1 and must not be used.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef PUMPPWM_H
+#define PUMPPWM_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// PUMP PWM FUNCTIONS
+// ============================================================================
+
+/**
+ * Configure Timer1 and start with the output LOW
+ * Called by pumpInit()
+ */
+void pumpPwmInit();
+
+/**
+ * Set the PWM duty
+ * @param level: 0-PUMP_HIRES_MAX (0 = output held LOW)
+ */
+void pumpPwmWrite(uint16_t level);
+
+/**
+ * Disconnect the output from the timer and hold it LOW
+ * Safe to call from interrupt handlers (single 8-bit register writes)
+ */
+void pumpPwmForceOff();
+
+/**
+ * Get the number of timer steps per PWM period
+ * @return ICR1 + 1 (800 at 20 kHz)
+ */
+uint16_t pumpPwmGetSteps();
+
+#endif // PUMPPWM_H
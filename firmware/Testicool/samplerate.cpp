@@ -0,0 +1,142 @@
+/*
+ * samplerate.cpp
+ * Adaptive temperature sampling rate implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "samplerate.h"
+#include "config.h"
+#include "uart.h"
+#include "controltick.h"
+#include "pump.h"
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+// Indexed by SampleRateLevel
+static const uint16_t levelPeriods[] = {
+  TEMP_RATE_IDLE_MS, TEMP_READ_INTERVAL_MS, TEMP_RATE_ACTIVE_MS, TEMP_RATE_FAST_MS
+};
+
+#if DEBUG_MODE
+static const char nameIdle[] PROGMEM   = "IDLE";
+static const char nameNormal[] PROGMEM = "NORMAL";
+static const char nameActive[] PROGMEM = "ACTIVE";
+static const char nameFast[] PROGMEM   = "FAST";
+
+// Indexed by SampleRateLevel (flash)
+static const char* const levelNames[] PROGMEM = { nameIdle, nameNormal, nameActive, nameFast };
+#endif
+
+static SampleRateLevel level = SAMPLE_RATE_NORMAL;
+static uint8_t lastPumpSpeed = 0;             // Commanded speed at the last counted change
+static unsigned long lastPumpChangeMs = 0;
+static unsigned long lastMovingMs = 0;         // Last time a temperature was not steady
+static unsigned long levelNeededMs = 0;        // Last time the current level (or faster) was wanted
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static SampleRateLevel wantedLevel(const ThermalEstimate& estimate, uint8_t pumpSpeed, unsigned long now) {
+  // Distance from the overheat threshold, now and at the horizon
+  int32_t projected = estimate.skinTemp + (int32_t)estimate.skinRate * TEMP_RATE_HORIZON_S / 10;
+  if (estimate.skinTemp >= OVERHEAT_TEMP_C - CENTI_C(TEMP_RATE_NEAR_MARGIN_C) ||
+      projected >= OVERHEAT_TEMP_C) {
+    return SAMPLE_RATE_FAST;
+  }
+
+  int16_t slope = max(abs(estimate.skinRate), abs(estimate.waterRate));
+  if (now - lastPumpChangeMs < TEMP_RATE_BOOST_MS || slope >= TEMP_RATE_FAST_SLOPE) {
+    return SAMPLE_RATE_ACTIVE;
+  }
+
+  if (pumpSpeed == 0 && now - lastMovingMs >= TEMP_RATE_IDLE_AFTER_MS) {
+    return SAMPLE_RATE_IDLE;
+  }
+
+  return SAMPLE_RATE_NORMAL;
+}
+
+// The control step (POT channel: estimator, thermostat, pot) needs its
+// full rate while the pump runs; with the pump off it follows the
+// temperature rate, and once both are slow the ADC runs on demand
+static void applyControlPeriod() {
+  uint16_t periodMs = (pumpGetState() == PUMP_ON) ? SPEED_READ_INTERVAL_MS : levelPeriods[level];
+  controlTickSetPeriodMs(CTRL_CH_SPEED_POT, periodMs);
+}
+
+static void applyLevel(SampleRateLevel newLevel) {
+  level = newLevel;
+  controlTickSetPeriodMs(CTRL_CH_TEMPERATURE, levelPeriods[level]);
+  applyControlPeriod();
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[RATE] Temperature sampling "));
+    DEBUG_SERIAL.print(reinterpret_cast<const __FlashStringHelper*>(pgm_read_ptr(&levelNames[level])));
+    DEBUG_SERIAL.print(F(" - "));
+    DEBUG_SERIAL.print(levelPeriods[level]);
+    DEBUG_SERIAL.println(F(" ms"));
+  #endif
+}
+
+// ============================================================================
+// SAMPLE RATE
+// ============================================================================
+
+void sampleRateInit() {
+  unsigned long now = millis();
+  lastPumpSpeed = 0;
+  lastPumpChangeMs = now;
+  lastMovingMs = now;
+  levelNeededMs = now;
+  applyLevel(SAMPLE_RATE_NORMAL);
+}
+
+void sampleRateUpdate(const ThermalEstimate& estimate, uint8_t pumpSpeed) {
+  unsigned long now = millis();
+
+  // Start, stop, or a real speed change - not the PID trimming a few counts
+  bool startStop = (pumpSpeed == 0) != (lastPumpSpeed == 0);
+  if (startStop || abs((int16_t)pumpSpeed - lastPumpSpeed) >= TEMP_RATE_SPEED_STEP) {
+    lastPumpSpeed = pumpSpeed;
+    lastPumpChangeMs = now;
+  }
+  if (abs(estimate.skinRate) > TEMP_RATE_STEADY_SLOPE || abs(estimate.waterRate) > TEMP_RATE_STEADY_SLOPE) {
+    lastMovingMs = now;
+  }
+
+  SampleRateLevel wanted = wantedLevel(estimate, pumpSpeed, now);
+  if (wanted >= level) {
+    levelNeededMs = now;
+    if (wanted > level) {
+      applyLevel(wanted);
+    }
+  } else if (now - levelNeededMs >= TEMP_RATE_HOLD_MS) {
+    levelNeededMs = now;
+    applyLevel(wanted);
+  }
+
+  // Pump stopped: slow the control step down with the temperature rate
+  applyControlPeriod();
+}
+
+void sampleRatePumpStarted() {
+  applyControlPeriod();
+}
+
+SampleRateLevel sampleRateGetLevel() {
+  return level;
+}
+
+char* sampleRateFormatHz(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 8) {
+    return NULL;
+  }
+
+  unsigned int tenthsHz = 10000U / levelPeriods[level];
+  snprintf_P(buffer, bufferSize, PSTR("%u.%uHz"), tenthsHz / 10, tenthsHz % 10);
+  return buffer;
+}
@@ -0,0 +1,89 @@
+/*
+ * samplerate.h
+ * Adaptive temperature sampling rate header for Testicool device
+ *
+ * The TEMP task (overheat check) runs at one of four rates, picked from
+ * the estimator output and the pump speed:
+ * - FAST (TEMP_RATE_FAST_MS): skin within TEMP_RATE_NEAR_MARGIN_C of
+ *   OVERHEAT_TEMP_C, or projected to reach it within TEMP_RATE_HORIZON_S
+ * - ACTIVE (TEMP_RATE_ACTIVE_MS): pump started, stopped or commanded to a
+ *   speed TEMP_RATE_SPEED_STEP away from the last change within
+ *   TEMP_RATE_BOOST_MS, or a temperature moving faster than
+ *   TEMP_RATE_FAST_SLOPE. The PID's small steps and the water
+ *   feedforward do not count, or the rate would never leave ACTIVE
+ * - IDLE (TEMP_RATE_IDLE_MS): pump off and both temperatures steady for
+ *   TEMP_RATE_IDLE_AFTER_MS
+ * - NORMAL (TEMP_READ_INTERVAL_MS): everything else
+ *
+ * A faster rate applies at once; a slower one only after the faster one
+ * has not been needed for TEMP_RATE_HOLD_MS, so the rate does not flap.
+ *
+ * The control step (POT task: snapshot, estimator, thermostat, pot) runs
+ * every SPEED_READ_INTERVAL_MS while the pump is on. With the pump off
+ * nothing needs it faster than the temperature, so it follows the TEMP
+ * rate, the estimator switching to the gains of that period. Once both
+ * channels are at ADC_ON_DEMAND_MIN_MS or slower (pump off, NORMAL or
+ * IDLE), the ADC engine only runs in a short burst before each sample
+ * and the CPU sleeps in between (see adcengine.h).
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef SAMPLERATE_H
+#define SAMPLERATE_H
+
+#include <Arduino.h>
+#include "estimator.h"
+
+// Sampling rate levels, slowest first
+enum SampleRateLevel {
+  SAMPLE_RATE_IDLE = 0,
+  SAMPLE_RATE_NORMAL,
+  SAMPLE_RATE_ACTIVE,
+  SAMPLE_RATE_FAST
+};
+
+// ============================================================================
+// SAMPLE RATE FUNCTIONS
+// ============================================================================
+
+/**
+ * Start at the NORMAL rate
+ * Call once in setup(), before controlTickInit()
+ */
+void sampleRateInit();
+
+/**
+ * Pick the temperature sampling rate for the current conditions and apply
+ * it to the control tick's temperature channel, and the control step
+ * period to its POT channel
+ * Cheap; called on every control step (POT task) so a pump change or a
+ * climbing temperature is seen within one estimator step
+ * @param estimate: latest thermal estimate
+ * @param pumpSpeed: commanded pump speed before the feedforward, 0-255 (0 = off)
+ */
+void sampleRateUpdate(const ThermalEstimate& estimate, uint8_t pumpSpeed);
+
+/**
+ * Put the control step back to SPEED_READ_INTERVAL_MS at once
+ * Called by pumpOn(), so the pot and the thermostat do not wait out a
+ * slow period
+ */
+void sampleRatePumpStarted();
+
+/**
+ * Get the current level
+ * @return SampleRateLevel
+ */
+SampleRateLevel sampleRateGetLevel();
+
+/**
+ * Format the current temperature sampling rate
+ * Format: "<Hz with one decimal>Hz", e.g. "0.2Hz" (buffer of at least 8 bytes)
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* sampleRateFormatHz(char* buffer, size_t bufferSize);
+
+#endif // SAMPLERATE_H
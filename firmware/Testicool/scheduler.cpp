@@ -0,0 +1,235 @@
+/*
+ * scheduler.cpp
+ * Cooperative task scheduler implementation for Testicool device
+ *
+ * Release times are kept in micros() so lateness can be measured with
+ * microsecond resolution. All comparisons use unsigned subtraction, which
+ * stays correct across the ~71 minute micros() rollover as long as no
+ * period is longer than half of it.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "scheduler.h"
+#include "config.h"
+#include "uart.h"
+#include "watchdog.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static SchedulerTask* taskTable = NULL;
+static uint8_t taskCount = 0;
+static volatile uint16_t triggerMask = 0;  // One bit per task released by schedulerTrigger()
+
+// Task in progress, read by the watchdog interrupt. runningSinceUs is only
+// written while runningTask is SCHEDULER_NO_TASK, so it is never seen torn.
+static volatile uint8_t runningTask = SCHEDULER_NO_TASK;
+static volatile unsigned long runningSinceUs = 0;
+
+// ============================================================================
+// SCHEDULER INITIALIZATION
+// ============================================================================
+
+void schedulerInit(SchedulerTask* tasks, uint8_t count) {
+  taskTable = tasks;
+  taskCount = count;
+
+  unsigned long now = micros();
+  for (uint8_t i = 0; i < taskCount; i++) {
+    taskTable[i].nextReleaseUs = now + (unsigned long)taskTable[i].phaseMs * 1000UL;
+  }
+
+  schedulerResetStats();
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[SCHED] Initialized - Tasks: "));
+    DEBUG_SERIAL.println(taskCount);
+  #endif
+}
+
+// ============================================================================
+// TASK DISPATCH
+// ============================================================================
+
+bool schedulerRun() {
+  for (uint8_t i = 0; i < taskCount; i++) {
+    SchedulerTask& task = taskTable[i];
+    uint16_t taskBit = (uint16_t)1 << i;
+
+    // Event release from schedulerTrigger() takes precedence
+    bool triggered = false;
+    unsigned long release = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      if (triggerMask & taskBit) {
+        triggerMask &= ~taskBit;
+        release = task.triggeredAtUs;
+        triggered = true;
+      }
+    }
+
+    unsigned long start = micros();
+    if (!triggered) {
+      if (task.periodMs == 0 || (long)(start - task.nextReleaseUs) < 0) {
+        continue;  // Not due yet
+      }
+      release = task.nextReleaseUs;
+    }
+
+    unsigned long lateness = start - release;
+
+    runningSinceUs = start;
+    runningTask = i;
+    task.run();
+    runningTask = SCHEDULER_NO_TASK;
+
+    unsigned long finish = micros();
+
+    // Lateness statistics
+    task.runs++;
+    task.latenessSumUs += lateness;
+    if (lateness > task.latenessMaxUs) {
+      task.latenessMaxUs = lateness;
+    }
+
+    // Deadline is measured from release, so it includes the lateness
+    if (finish - release > (unsigned long)task.deadlineMs * 1000UL) {
+      task.deadlineMisses++;
+    }
+
+    // Overrun: the task alone used more than its deadline. Lateness caused
+    // by other tasks is not counted, so the log blames the right task.
+    if (finish - start > (unsigned long)task.deadlineMs * 1000UL) {
+      watchdogRecordOverrun(i, finish - start);
+    }
+
+    // Next release stays on the original grid (no drift). If a stall made
+    // us miss whole periods, drop them instead of running a burst.
+    // Triggered runs leave the periodic grid untouched.
+    if (!triggered) {
+      unsigned long periodUs = (unsigned long)task.periodMs * 1000UL;
+      task.nextReleaseUs = release + periodUs;
+      if ((long)(finish - task.nextReleaseUs) >= 0) {
+        unsigned long behind = (finish - task.nextReleaseUs) / periodUs + 1;
+        task.nextReleaseUs += behind * periodUs;
+        task.skippedReleases += (uint16_t)behind;
+      }
+    }
+
+    // Return after each task so higher-priority tasks are re-checked first
+    return true;
+  }
+
+  return false;
+}
+
+void schedulerTrigger(uint8_t index) {
+  if (index >= taskCount) {
+    return;
+  }
+
+  uint16_t taskBit = (uint16_t)1 << index;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (!(triggerMask & taskBit)) {
+      taskTable[index].triggeredAtUs = micros();
+      triggerMask |= taskBit;
+    }
+  }
+}
+
+bool schedulerHasPendingTrigger() {
+  return triggerMask != 0;
+}
+
+unsigned long schedulerGetIdleTimeUs() {
+  if (triggerMask != 0) {
+    return 0;
+  }
+
+  unsigned long now = micros();
+  unsigned long idle = 0xFFFFFFFFUL;
+
+  for (uint8_t i = 0; i < taskCount; i++) {
+    if (taskTable[i].periodMs == 0) {
+      continue;  // Event-driven only - its trigger will wake us
+    }
+    long remaining = (long)(taskTable[i].nextReleaseUs - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    if ((unsigned long)remaining < idle) {
+      idle = remaining;
+    }
+  }
+
+  return idle;
+}
+
+// ============================================================================
+// DIAGNOSTICS
+// ============================================================================
+
+uint8_t schedulerGetRunningTask(unsigned long* sinceUs) {
+  uint8_t task = runningTask;
+  if (sinceUs != NULL) {
+    *sinceUs = runningSinceUs;
+  }
+  return task;
+}
+
+uint8_t schedulerGetTaskCount() {
+  return taskCount;
+}
+
+const SchedulerTask* schedulerGetTask(uint8_t index) {
+  if (index >= taskCount) {
+    return NULL;
+  }
+  return &taskTable[index];
+}
+
+void schedulerResetStats() {
+  for (uint8_t i = 0; i < taskCount; i++) {
+    taskTable[i].runs = 0;
+    taskTable[i].latenessSumUs = 0;
+    taskTable[i].latenessMaxUs = 0;
+    taskTable[i].deadlineMisses = 0;
+    taskTable[i].skippedReleases = 0;
+  }
+}
+
+char* schedulerGetTaskName(uint8_t index, char* buffer, size_t bufferSize) {
+  const SchedulerTask* task = schedulerGetTask(index);
+  if (task == NULL || buffer == NULL || bufferSize < SCHEDULER_TASK_NAME_SIZE) {
+    return NULL;
+  }
+
+  strncpy_P(buffer, task->name, bufferSize - 1);
+  buffer[bufferSize - 1] = '\0';
+  return buffer;
+}
+
+char* schedulerGetTaskStatsString(uint8_t index, char* buffer, size_t bufferSize) {
+  const SchedulerTask* task = schedulerGetTask(index);
+  if (task == NULL || buffer == NULL || bufferSize < 50) {
+    return NULL;
+  }
+
+  char name[SCHEDULER_TASK_NAME_SIZE];
+  schedulerGetTaskName(index, name, sizeof(name));
+  unsigned long meanLateness = task->runs ? task->latenessSumUs / task->runs : 0;
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("TASK:%s,Period:%ums,Runs:%lu,Late:%lu/%luus,Miss:%u,Skip:%u"),
+             name,
+             task->periodMs,
+             task->runs,
+             meanLateness,
+             task->latenessMaxUs,
+             task->deadlineMisses,
+             task->skippedReleases);
+
+  return buffer;
+}
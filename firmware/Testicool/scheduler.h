@@ -0,0 +1,145 @@
+/*
+ * scheduler.h
+ * Cooperative task scheduler header for Testicool device
+ *
+ * Replaces the fixed delay(LOOP_DELAY_MS) super-loop with a static table
+ * of periodic tasks. Every task has:
+ * - A period (how often it is released, 0 = event-driven only)
+ * - A phase offset (delay of the first release, used to spread load)
+ * - A deadline (how long after release the task must have finished)
+ *
+ * loop() calls schedulerRun() continuously. The highest-priority task
+ * that is due (lowest table index) runs to completion, then control
+ * returns to loop(). Nothing ever waits in a blocking delay.
+ *
+ * Interrupt handlers can also release a task immediately with
+ * schedulerTrigger() (e.g. when the control tick has a new sample).
+ *
+ * Per-task lateness (release -> start) and deadline misses are tracked
+ * so the TASKS command can show how responsive the loop really is.
+ * A task whose own run time exceeds its deadline is also handed to the
+ * stall log (see watchdog.h).
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_NO_TASK  0xFF   // No task running / invalid task index
+
+// One entry of the static task table (defined in Testicool.ino)
+struct SchedulerTask {
+  // ----- Configuration (set in the table initializer) -----
+  PGM_P name;                    // Short name shown by the TASKS command (flash string)
+  void (*run)();                 // Task body - must return quickly, never block
+  uint16_t periodMs;             // Release period in milliseconds (0 = only via schedulerTrigger())
+  uint16_t phaseMs;              // Offset of the first release after schedulerInit()
+  uint16_t deadlineMs;           // Allowed release -> finish time in milliseconds
+
+  // ----- Runtime state (managed by the scheduler, SCHEDULER_TASK() zeroes it) -----
+  unsigned long nextReleaseUs;   // micros() timestamp of the next periodic release
+  unsigned long triggeredAtUs;   // micros() timestamp of the pending schedulerTrigger()
+  unsigned long runs;            // Number of completed runs
+  unsigned long latenessSumUs;   // Sum of release -> start delays (for the mean)
+  unsigned long latenessMaxUs;   // Worst release -> start delay
+  uint16_t deadlineMisses;       // Runs that finished after their deadline
+  uint16_t skippedReleases;      // Whole periods dropped after a long stall
+};
+
+// Table entry with the runtime state zeroed; name is a PROGMEM string
+#define SCHEDULER_TASK(name, run, periodMs, phaseMs, deadlineMs) \
+  { name, run, periodMs, phaseMs, deadlineMs, 0, 0, 0, 0, 0, 0, 0 }
+
+#define SCHEDULER_TASK_NAME_SIZE  8   // Longest task name + terminator
+
+// ============================================================================
+// SCHEDULER FUNCTIONS
+// ============================================================================
+
+/**
+ * Initialize the scheduler with a static task table
+ * Computes the first release of each task from its phase offset
+ * Call this function once at the end of setup()
+ * @param tasks: task table (order = priority, index 0 is highest)
+ * @param count: number of entries in the table
+ */
+void schedulerInit(SchedulerTask* tasks, uint8_t count);
+
+/**
+ * Run the highest-priority task that is due, if any
+ * Call this function continuously from loop()
+ * @return true if a task was run
+ */
+bool schedulerRun();
+
+/**
+ * Release a task immediately, independent of its period
+ * Safe to call from interrupt handlers. Repeated triggers before the
+ * task runs are merged into one release (lateness is measured from the first).
+ * @param index: task index in the table (max 16 tasks)
+ */
+void schedulerTrigger(uint8_t index);
+
+/**
+ * Check whether any task has been released by schedulerTrigger()
+ * Safe to call with interrupts disabled (used as a sleep wake check)
+ * @return true if a triggered task is waiting to run
+ */
+bool schedulerHasPendingTrigger();
+
+/**
+ * Get time until the next periodic release
+ * Used by the idle sleep to decide how long the CPU may sleep
+ * @return microseconds until the earliest release, 0 if a task is already due
+ */
+unsigned long schedulerGetIdleTimeUs();
+
+/**
+ * Get the task that is currently running
+ * Safe to call from interrupt handlers (used by the watchdog interrupt)
+ * @param sinceUs: receives the micros() timestamp the task was started
+ * @return task index, SCHEDULER_NO_TASK if no task is running
+ */
+uint8_t schedulerGetRunningTask(unsigned long* sinceUs);
+
+/**
+ * Get number of tasks in the table
+ * @return task count (0 before schedulerInit())
+ */
+uint8_t schedulerGetTaskCount();
+
+/**
+ * Get read-only access to a task entry for diagnostics
+ * @param index: task index (0 to schedulerGetTaskCount() - 1)
+ * @return pointer to the task, NULL if index is out of range
+ */
+const SchedulerTask* schedulerGetTask(uint8_t index);
+
+/**
+ * Copy the name of a task out of flash
+ * @param index: task index
+ * @param buffer: character array to store the name
+ * @param bufferSize: size of buffer array, at least SCHEDULER_TASK_NAME_SIZE
+ * @return pointer to buffer, NULL if index is out of range
+ */
+char* schedulerGetTaskName(uint8_t index, char* buffer, size_t bufferSize);
+
+/**
+ * Clear lateness and deadline statistics of all tasks
+ */
+void schedulerResetStats();
+
+/**
+ * Format lateness statistics of one task
+ * Format: "TASK:<name>,Period:<ms>,Runs:<n>,Late:<mean>/<max>us,Miss:<n>,Skip:<n>"
+ * @param index: task index
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer, NULL if index is out of range
+ */
+char* schedulerGetTaskStatsString(uint8_t index, char* buffer, size_t bufferSize);
+
+#endif // SCHEDULER_H
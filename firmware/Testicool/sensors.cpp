@@ -0,0 +1,118 @@
+/*
+ * sensors.cpp
+ * Sensor snapshot implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "sensors.h"
+#include "config.h"
+#include "adcengine.h"
+#include "thermistor.h"
+#include "calibration.h"
+#include "supply.h"
+#include "controltick.h"
+#include <util/atomic.h>
+
+// ============================================================================
+// CHANNEL TABLE
+// ============================================================================
+
+#define CHANNEL_ROLE(name, pin, role, offset)     role,
+#define CHANNEL_IS_WATER(name, pin, role, offset) + ((role) == SENSOR_ROLE_WATER)
+#define CHANNEL_IS_SKIN(name, pin, role, offset)  + ((role) == SENSOR_ROLE_SKIN)
+
+#define WATER_CHANNEL_COUNT  (0 TEMP_CHANNELS(CHANNEL_IS_WATER))
+
+static_assert(WATER_CHANNEL_COUNT > 0 && (0 TEMP_CHANNELS(CHANNEL_IS_SKIN)) > 0,
+              "TEMP_CHANNELS needs at least one water and one skin channel");
+
+static const uint8_t channelRoles[TEMP_CHANNEL_COUNT] = { TEMP_CHANNELS(CHANNEL_ROLE) };
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static SensorSnapshot snapshot;
+
+// ============================================================================
+// SNAPSHOT
+// ============================================================================
+
+// One pass over the channels: convert, calibrate, combine by role
+static void convertSample(const ControlSample& sample) {
+  const uint16_t* readings = sample.readings;
+
+  int32_t waterSum = 0;
+  int16_t skinMax = INT16_MIN;
+  for (uint8_t ch = 0; ch < TEMP_CHANNEL_COUNT; ch++) {
+    #if SIMULATE_TEMPERATURE
+      int16_t temp = (channelRoles[ch] == SENSOR_ROLE_WATER) ? SIMULATED_WATER_TEMP_C : SIMULATED_SKIN_TEMP_C;
+    #else
+      uint16_t reading = supplyCorrectThermistor(readings[ch]);
+      int16_t temp = calibrationApply(ch, thermistorToCentiCelsius(reading, ADC_OVERSAMPLE_BITS));
+    #endif
+
+    snapshot.temps[ch] = temp;
+    if (channelRoles[ch] == SENSOR_ROLE_WATER) {
+      waterSum += temp;
+    } else if (temp > skinMax) {
+      skinMax = temp;
+    }
+  }
+  snapshot.waterTemp = (int16_t)(waterSum / WATER_CHANNEL_COUNT);
+  snapshot.skinTemp = skinMax;
+
+  // The pot needs no extra resolution; its filter already steadies it
+  snapshot.potValue = readings[ADC_INPUT_POT] >> ADC_OVERSAMPLE_BITS;
+  snapshot.timeUs = sample.timeUs;
+}
+
+void sensorsInit() {
+  // The control tick is not running yet - take the engine's readings now
+  ControlSample sample;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < CTRL_SAMPLE_INPUTS; i++) {
+      sample.readings[i] = adcEngineGetValueFromISR(i);
+    }
+    sample.timeUs = micros();
+  }
+  convertSample(sample);
+}
+
+void sensorsRefresh(ControlChannel channel) {
+  ControlSample sample;
+  controlTickGetSample(channel, &sample);
+
+  // The other channel may have latched later and run first - never step
+  // the snapshot back to an older instant
+  if ((long)(sample.timeUs - snapshot.timeUs) <= 0) {
+    return;
+  }
+  convertSample(sample);
+}
+
+const SensorSnapshot& sensorsGet() {
+  return snapshot;
+}
+
+unsigned long sensorsGetAgeMs() {
+  return (micros() - snapshot.timeUs) / 1000UL;
+}
+
+// ============================================================================
+// CHANNEL ACCESS
+// ============================================================================
+
+SensorRole sensorsGetRole(uint8_t channel) {
+  return (channel < TEMP_CHANNEL_COUNT) ? (SensorRole)channelRoles[channel] : SENSOR_ROLE_WATER;
+}
+
+char* sensorsGetRoleName(SensorRole role, char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 6) {
+    return NULL;
+  }
+
+  strcpy_P(buffer, (role == SENSOR_ROLE_SKIN) ? PSTR("SKIN") : PSTR("WATER"));
+  return buffer;
+}
@@ -0,0 +1,98 @@
+/*
+ * sensors.h
+ * Sensor snapshot header for Testicool device
+ *
+ * One snapshot holds the latest temperature of every channel in the
+ * TEMP_CHANNELS table (config.h) and the potentiometer position, all taken
+ * from the readings the control tick latched at one sample instant
+ * (controltick.h) and stamped with that instant. The sampling tasks
+ * refresh it; the estimator and TEMP read the same copy, so they cost no
+ * ADC or conversion time and never disagree with each other. How late a
+ * task gets to run changes only the age of the snapshot, not its time.
+ *
+ * Channels are processed in one pass and combined by role:
+ * - waterTemp: mean of the SENSOR_ROLE_WATER channels (e.g. inlet/outlet)
+ * - skinTemp: hottest SENSOR_ROLE_SKIN channel (the overheat check
+ *   protects the worst contact point)
+ *
+ * RAM per channel (ATmega328P, FILTER_MEDIAN_SIZE 5): 23 bytes of ADC
+ * result and filter state, 3 bytes of pin/name tables plus the name
+ * string, 18 bytes of calibration, 2 bytes of snapshot and 1 byte of role,
+ * about 47 bytes plus the name. Each channel adds one reading (1.8 ms at
+ * ADC_OVERSAMPLE_BITS 2) to the ADC engine cycle and one table conversion
+ * to sensorsRefresh(); 4 bytes of EEPROM hold its calibration.
+ *
+ * With SIMULATE_TEMPERATURE every channel reads the simulated value of
+ * its role from config.h, so readers need no special case.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "controltick.h"
+
+// What a temperature channel measures
+enum SensorRole {
+  SENSOR_ROLE_WATER = 0,     // Coolant
+  SENSOR_ROLE_SKIN           // Skin contact point
+};
+
+// Values captured together
+struct SensorSnapshot {
+  int16_t temps[TEMP_CHANNEL_COUNT];  // Per channel, hundredths of a degree Celsius, calibrated (calibration.h)
+  int16_t waterTemp;         // Mean of the water channels
+  int16_t skinTemp;          // Hottest skin channel
+  uint16_t potValue;         // Speed potentiometer, 0-1023
+  unsigned long timeUs;      // micros() of the sample instant
+};
+
+// ============================================================================
+// SENSOR FUNCTIONS
+// ============================================================================
+
+/**
+ * Take the first snapshot straight from the ADC engine
+ * Call once in setup(), after adcEngineInit() and calibrationInit()
+ */
+void sensorsInit();
+
+/**
+ * Convert the readings latched at a channel's last sample instant into a new snapshot
+ * Called by the sampling tasks; one table lookup per channel, no ADC time
+ * @param channel: control tick channel that released the caller
+ */
+void sensorsRefresh(ControlChannel channel);
+
+/**
+ * Get the current snapshot
+ * @return snapshot (valid until the next sensorsRefresh())
+ */
+const SensorSnapshot& sensorsGet();
+
+/**
+ * Get the age of the current snapshot
+ * @return milliseconds since its sample instant
+ */
+unsigned long sensorsGetAgeMs();
+
+/**
+ * Get the role of a temperature channel
+ * @param channel: channel index (row of TEMP_CHANNELS)
+ * @return SensorRole
+ */
+SensorRole sensorsGetRole(uint8_t channel);
+
+/**
+ * Copy the protocol name of a role ("WATER" or "SKIN")
+ * @param role: SensorRole
+ * @param buffer: character array to store the name
+ * @param bufferSize: size of buffer array (at least 6 bytes)
+ * @return pointer to buffer
+ */
+char* sensorsGetRoleName(SensorRole role, char* buffer, size_t bufferSize);
+
+#endif // SENSORS_H
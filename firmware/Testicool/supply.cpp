@@ -0,0 +1,119 @@
+/*
+ * supply.cpp
+ * Supply voltage measurement implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "supply.h"
+#include "config.h"
+#include "uart.h"
+#include "adcengine.h"
+
+// Pump divider ratio in 8.8 fixed point
+static constexpr uint16_t DIVIDER_Q8 = (uint16_t)(PUMP_SUPPLY_DIVIDER * 256 + 0.5);
+
+static_assert(PUMP_SUPPLY_DIVIDER >= 1.0 && PUMP_SUPPLY_DIVIDER < 16.0, "PUMP_SUPPLY_DIVIDER out of range");
+static_assert(PUMP_SUPPLY_MIN_MV > 0 && PUMP_SUPPLY_MIN_MV < PUMP_SUPPLY_NOMINAL_MV,
+              "PUMP_SUPPLY_MIN_MV must be below PUMP_SUPPLY_NOMINAL_MV");
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static uint16_t vccMv = 5000;
+static uint16_t pumpMv = 0;           // 0 = not measured
+
+// ============================================================================
+// SUPPLY
+// ============================================================================
+
+void supplyInit() {
+  supplyUpdate();
+
+  #if DEBUG_MODE
+    DEBUG_SERIAL.print(F("[SUPPLY] Vcc: "));
+    DEBUG_SERIAL.print(vccMv);
+    DEBUG_SERIAL.print(F(" mV, pump supply: "));
+    DEBUG_SERIAL.print(pumpMv);
+    DEBUG_SERIAL.println(F(" mV"));
+  #endif
+}
+
+void supplyUpdate() {
+  uint16_t bandgap = adcEngineGetValue(ADC_INPUT_BANDGAP);
+  if (bandgap > 0) {
+    vccMv = (uint16_t)(((uint32_t)BANDGAP_MV * ADC_RESULT_MAX + bandgap / 2) / bandgap);
+  }
+
+  #if PUMP_SUPPLY_SENSE_ENABLED
+    uint32_t pinMv = (uint32_t)adcEngineGetValue(ADC_INPUT_PUMP_SUPPLY) * vccMv / ADC_RESULT_MAX;
+    pumpMv = (uint16_t)min((pinMv * DIVIDER_Q8) >> 8, 0xFFFFUL);
+  #endif
+}
+
+uint16_t supplyGetVccMv() {
+  return vccMv;
+}
+
+uint16_t supplyGetPumpMv() {
+  return pumpMv;
+}
+
+uint16_t supplyCompensateDuty(uint16_t level) {
+  if (pumpMv < PUMP_SUPPLY_MIN_MV) {
+    return level;                     // No divider, or pump supply switched off
+  }
+
+  uint32_t duty = ((uint32_t)level * PUMP_SUPPLY_NOMINAL_MV + pumpMv / 2) / pumpMv;
+  return (uint16_t)min(duty, (uint32_t)SPEED_TO_HIRES(PUMP_MAX_SPEED));
+}
+
+uint16_t supplyCorrectThermistor(uint16_t reading) {
+  #if THERMISTOR_RATIOMETRIC
+    return reading;
+  #else
+    // reading = Vdivider / Vcc, the table wants Vdivider / divider supply
+    uint32_t corrected = ((uint32_t)reading * vccMv + THERMISTOR_SUPPLY_MV / 2) / THERMISTOR_SUPPLY_MV;
+    return (uint16_t)min(corrected, (uint32_t)ADC_RESULT_MAX);
+  #endif
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* supplyFormatVolts(uint16_t millivolts, char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 8) {
+    return NULL;
+  }
+
+  uint16_t hundredths = (millivolts + 5) / 10;
+  snprintf_P(buffer, bufferSize, PSTR("%u.%02u"), hundredths / 100, hundredths % 100);
+  return buffer;
+}
+
+char* supplyGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 64) {
+    return NULL;
+  }
+
+  char vccStr[8];
+  char pumpStr[8];
+  supplyFormatVolts(vccMv, vccStr, sizeof(vccStr));
+  if (pumpMv >= PUMP_SUPPLY_MIN_MV) {
+    supplyFormatVolts(pumpMv, pumpStr, sizeof(pumpStr));
+    strcat_P(pumpStr, PSTR("V"));
+  } else {
+    strcpy_P(pumpStr, PSTR("-"));
+  }
+
+  // Duty scale in percent (100 = uncompensated)
+  unsigned int scale = (pumpMv >= PUMP_SUPPLY_MIN_MV)
+                       ? (unsigned int)(((uint32_t)PUMP_SUPPLY_NOMINAL_MV * 100 + pumpMv / 2) / pumpMv)
+                       : 100;
+
+  snprintf_P(buffer, bufferSize, PSTR("SUPPLY:{Vcc:%sV,Bandgap:%u,Pump:%s,Scale:%u%%}"),
+             vccStr, adcEngineGetValue(ADC_INPUT_BANDGAP), pumpStr, scale);
+  return buffer;
+}
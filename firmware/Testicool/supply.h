@@ -0,0 +1,96 @@
+/*
+ * supply.h
+ * Supply voltage measurement header for Testicool device
+ *
+ * The ADC engine reads the internal 1.1 V bandgap against AVcc every
+ * cycle, which gives the Nano's own supply without any wiring:
+ *
+ *   Vcc = BANDGAP_MV * ADC_RESULT_MAX / bandgap reading
+ *
+ * With a divider from the pump supply (PUMP_SUPPLY_SENSE_ENABLED) that
+ * reading is scaled by the measured Vcc, so it does not depend on the 5 V
+ * rail being exact.
+ *
+ * Uses of the measurement:
+ * - Pump PWM: the 12 V pack sags as it discharges, and a fixed duty then
+ *   delivers less and less flow. The duty is scaled by
+ *   PUMP_SUPPLY_NOMINAL_MV / measured supply, which keeps the average
+ *   voltage across the pump - and with it the pump power - constant
+ *   until full duty is reached. Without the divider the pack cannot be
+ *   seen (the regulator holds the 5 V rail) and the duty is left alone.
+ * - Thermistors: dividers fed from AVcc are ratiometric and need no
+ *   correction. Dividers fed from another supply (THERMISTOR_RATIOMETRIC
+ *   false) are rescaled by Vcc / THERMISTOR_SUPPLY_MV before conversion.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef SUPPLY_H
+#define SUPPLY_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// SUPPLY FUNCTIONS
+// ============================================================================
+
+/**
+ * Take the first measurement
+ * Call once in setup(), after adcEngineInit()
+ */
+void supplyInit();
+
+/**
+ * Convert the latest ADC engine readings to millivolts
+ * Called by the SAFETY task; the readings are already filtered
+ */
+void supplyUpdate();
+
+/**
+ * Get the measured AVcc
+ * @return millivolts
+ */
+uint16_t supplyGetVccMv();
+
+/**
+ * Get the measured pump supply
+ * @return millivolts, 0 without a divider (PUMP_SUPPLY_SENSE_ENABLED false)
+ */
+uint16_t supplyGetPumpMv();
+
+/**
+ * Scale a pump duty for the measured pump supply
+ * @param level: PWM level 0-PUMP_HIRES_MAX meant at PUMP_SUPPLY_NOMINAL_MV
+ * @return PWM level giving the same average pump voltage (level itself
+ *         without a usable measurement), at most SPEED_TO_HIRES(PUMP_MAX_SPEED)
+ */
+uint16_t supplyCompensateDuty(uint16_t level);
+
+/**
+ * Correct a thermistor reading for a divider supply other than AVcc
+ * Returns the reading unchanged when THERMISTOR_RATIOMETRIC is true
+ * @param reading: ADC engine reading (ADC_RESULT_BITS)
+ * @return reading as if the divider ran from AVcc
+ */
+uint16_t supplyCorrectThermistor(uint16_t reading);
+
+/**
+ * Format a voltage with two decimals
+ * Format: "<volts>.<hundredths>", e.g. "4.98" (buffer of at least 8 bytes)
+ * @param millivolts: voltage in millivolts
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* supplyFormatVolts(uint16_t millivolts, char* buffer, size_t bufferSize);
+
+/**
+ * Get the supply measurements as formatted string
+ * Format: "SUPPLY:{Vcc:<V>,Bandgap:<reading>,Pump:<V or ->,Scale:<duty scale %>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* supplyGetStatusString(char* buffer, size_t bufferSize);
+
+#endif // SUPPLY_H
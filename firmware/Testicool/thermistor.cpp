@@ -0,0 +1,146 @@
+/*
+ * thermistor.cpp
+ * NTC thermistor ADC-to-temperature conversion implementation for Testicool device
+ *
+ * The table is a constexpr array, so the compiler must evaluate every
+ * entry: a parameter that is not a compile-time constant is a build
+ * error, never a silent startup computation. Compile-time floating point
+ * has the precision of the target's double (32-bit on AVR), far below the
+ * 0.01°C step of the table.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "thermistor.h"
+#include "config.h"
+#include "perf.h"
+#include <avr/pgmspace.h>
+
+#define KELVIN_OFFSET  273.15
+
+// ============================================================================
+// COMPILE-TIME MATH
+// ============================================================================
+
+static constexpr double LN2 = 0.69314718055994531;
+
+// Sum of y^n / n for odd n: atanh(y) for |y| <= 1/3 converges in a few terms
+static constexpr double atanhSeries(double y2, double power, int n) {
+  return n > 31 ? 0.0 : power / n + atanhSeries(y2, power * y2, n + 2);
+}
+
+// ln(x) for x > 0: halve/double x into [0.5, 2], then ln(m) = 2 atanh((m-1)/(m+1))
+static constexpr double lnMantissa(double y) {
+  return 2.0 * atanhSeries(y * y, y, 1);
+}
+
+static constexpr double lnScaled(double x, int exponent) {
+  return x > 2.0 ? lnScaled(x / 2.0, exponent + 1)
+       : x < 0.5 ? lnScaled(x * 2.0, exponent - 1)
+       : exponent * LN2 + lnMantissa((x - 1.0) / (x + 1.0));
+}
+
+static constexpr double constLn(double x) {
+  return lnScaled(x, 0);
+}
+
+// ============================================================================
+// RESISTANCE -> TEMPERATURE
+// ============================================================================
+
+#ifdef THERMISTOR_RT_TABLE
+
+struct RtPoint {
+  double celsius;
+  double ohms;
+};
+
+static constexpr RtPoint rtTable[] = THERMISTOR_RT_TABLE;
+static constexpr int RT_COUNT = sizeof(rtTable) / sizeof(rtTable[0]);
+
+static_assert(RT_COUNT >= 2, "THERMISTOR_RT_TABLE needs at least two points");
+
+static constexpr bool rtOrdered(int i) {
+  return i >= RT_COUNT - 1 ||
+         (rtTable[i].celsius < rtTable[i + 1].celsius &&
+          rtTable[i].ohms > rtTable[i + 1].ohms && rtOrdered(i + 1));
+}
+
+static_assert(rtOrdered(0), "THERMISTOR_RT_TABLE must list rising temperatures with falling resistance");
+
+// Segment i spans rtTable[i] .. rtTable[i + 1]; the end segments extrapolate
+static constexpr int rtSegment(double ohms, int i) {
+  return (i >= RT_COUNT - 2 || ohms > rtTable[i + 1].ohms) ? i : rtSegment(ohms, i + 1);
+}
+
+static constexpr double rtInverseKelvin(double ohms, int i) {
+  return 1.0 / (rtTable[i].celsius + KELVIN_OFFSET) +
+         (1.0 / (rtTable[i + 1].celsius + KELVIN_OFFSET) - 1.0 / (rtTable[i].celsius + KELVIN_OFFSET)) *
+         (constLn(ohms) - constLn(rtTable[i].ohms)) /
+         (constLn(rtTable[i + 1].ohms) - constLn(rtTable[i].ohms));
+}
+
+static constexpr double ohmsToCelsius(double ohms) {
+  return 1.0 / rtInverseKelvin(ohms, rtSegment(ohms, 0)) - KELVIN_OFFSET;
+}
+
+#else
+
+// B-parameter equation: 1/T = 1/T0 + (1/B) * ln(R/R0)
+static constexpr double ohmsToCelsius(double ohms) {
+  return 1.0 / (constLn(ohms / THERMISTOR_NOMINAL) / B_COEFFICIENT +
+                1.0 / (TEMPERATURE_NOMINAL + KELVIN_OFFSET)) - KELVIN_OFFSET;
+}
+
+#endif // THERMISTOR_RT_TABLE
+
+// ============================================================================
+// ADC CODE -> TABLE ENTRY
+// ============================================================================
+
+// Voltage divider: Vout = Vin * (R_series / (R_series + R_thermistor))
+// Therefore: R_thermistor = R_series * ((1023/ADC) - 1), ADC kept within 1..1022
+static constexpr double adcToOhms(int adc) {
+  return SERIES_RESISTOR * (1023.0 / (adc < 1 ? 1 : adc > 1022 ? 1022 : adc) - 1.0);
+}
+
+static constexpr int16_t toCentiCelsius(double celsius) {
+  return celsius >= 327.67 ? 32767
+       : celsius <= -327.67 ? -32767
+       : (int16_t)(celsius >= 0 ? celsius * 100.0 + 0.5 : celsius * 100.0 - 0.5);
+}
+
+static constexpr int16_t tableEntry(int adc) {
+  return toCentiCelsius(ohmsToCelsius(adcToOhms(adc)));
+}
+
+#define ENTRY_4(n)     tableEntry(n), tableEntry(n + 1), tableEntry(n + 2), tableEntry(n + 3)
+#define ENTRY_16(n)    ENTRY_4(n), ENTRY_4(n + 4), ENTRY_4(n + 8), ENTRY_4(n + 12)
+#define ENTRY_64(n)    ENTRY_16(n), ENTRY_16(n + 16), ENTRY_16(n + 32), ENTRY_16(n + 48)
+#define ENTRY_256(n)   ENTRY_64(n), ENTRY_64(n + 64), ENTRY_64(n + 128), ENTRY_64(n + 192)
+#define ENTRY_1024(n)  ENTRY_256(n), ENTRY_256(n + 256), ENTRY_256(n + 512), ENTRY_256(n + 768)
+
+static constexpr int16_t adcTable[THERMISTOR_TABLE_SIZE] PROGMEM = { ENTRY_1024(0) };
+
+// ============================================================================
+// CONVERSION
+// ============================================================================
+
+int16_t thermistorToCentiCelsius(uint16_t adc, uint8_t fractionBits) {
+  PERF_SCOPE(PERF_TEMP_CONVERT);
+
+  uint16_t code = adc >> fractionBits;
+  if (code >= THERMISTOR_TABLE_SIZE - 1) {
+    return (int16_t)pgm_read_word(&adcTable[THERMISTOR_TABLE_SIZE - 1]);
+  }
+
+  int16_t low = (int16_t)pgm_read_word(&adcTable[code]);
+  uint16_t fraction = adc & ((1U << fractionBits) - 1);
+  if (fraction == 0) {
+    return low;
+  }
+
+  // Linear between neighbouring codes for the oversampled bits
+  int16_t high = (int16_t)pgm_read_word(&adcTable[code + 1]);
+  return low + (int16_t)((((int32_t)high - low) * fraction) >> fractionBits);
+}
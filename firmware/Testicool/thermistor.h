@@ -0,0 +1,42 @@
+/*
+ * thermistor.h
+ * NTC thermistor ADC-to-temperature conversion header for Testicool device
+ *
+ * Every 10-bit ADC code maps to a temperature in a 1024-entry table that
+ * the compiler builds from the thermistor parameters in config.h and
+ * places in flash (2 KB). Converting a sample is one table read: no float
+ * division and no log() at run time.
+ *
+ * The table follows either:
+ * - the B equation (THERMISTOR_NOMINAL, TEMPERATURE_NOMINAL, B_COEFFICIENT)
+ * - a manufacturer R-T curve (THERMISTOR_RT_TABLE), interpolated
+ *   linearly in ln(R) vs 1/T between its points
+ *
+ * WIRING: Thermistor to +5V, SERIES_RESISTOR to GND
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef THERMISTOR_H
+#define THERMISTOR_H
+
+#include <Arduino.h>
+
+#define THERMISTOR_TABLE_SIZE  1024    // One entry per 10-bit ADC code
+
+// ============================================================================
+// THERMISTOR FUNCTIONS
+// ============================================================================
+
+/**
+ * Convert an ADC reading to temperature
+ * Codes 0 and 1023 read like 1 and 1022 (open / shorted sensor stays finite).
+ * Results beyond +/-327.67°C saturate. Oversampled readings interpolate
+ * linearly between the table entries around them.
+ * @param adc: ADC reading, 10 integer bits plus fractionBits (0 to 1023 << fractionBits)
+ * @param fractionBits: extra bits from oversampling (0 for a plain 10-bit reading)
+ * @return temperature in hundredths of a degree Celsius
+ */
+int16_t thermistorToCentiCelsius(uint16_t adc, uint8_t fractionBits = 0);
+
+#endif // THERMISTOR_H
@@ -0,0 +1,314 @@
+/*
+ * thermostat.cpp
+ * Closed-loop skin temperature control implementation for Testicool device
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "thermostat.h"
+#include "config.h"
+#include "uart.h"
+#include "pump.h"
+#include "bluetooth.h"
+#include "autotune.h"
+#include "eco.h"
+
+#define STEP_COUNT        (THERMOSTAT_PERIOD_MS / ESTIMATOR_PERIOD_MS)
+#define OUTPUT_MAX        ((int32_t)PUMP_MAX_SPEED << 16)    // Full duty, 16.16
+#define ERROR_LIMIT       CENTI_C(20.0)                      // Larger errors act as this one
+#define RATE_LIMIT        10000                              // m°C/s, likewise
+#define TERM_LIMIT        0x40000000L                        // Largest gain * limit, so P + I + D cannot overflow
+#define SETTLE_BAND       ((TARGET_TEMP_MAX_C - TARGET_TEMP_MIN_C) / 2)
+#define UNMEASURED        0xFFFFFFFFUL
+
+// Default gains in 16.16 duty per unit of the input they multiply
+static constexpr int32_t KP_Q16 = (int32_t)(THERMOSTAT_KP * 65536.0 / 100 + 0.5);     // per centi-degree
+static constexpr int32_t KI_Q16 = (int32_t)(THERMOSTAT_KI * 65536.0 / 100 *           // per centi-degree, per step
+                                            THERMOSTAT_PERIOD_MS / 1000 + 0.5);
+static constexpr int32_t KD_Q16 = (int32_t)(THERMOSTAT_KD * 65536.0 / 1000 + 0.5);    // per m°C/s
+
+static constexpr int16_t TARGET = (TARGET_TEMP_MIN_C + TARGET_TEMP_MAX_C) / 2;
+
+static_assert(THERMOSTAT_PERIOD_MS % ESTIMATOR_PERIOD_MS == 0 && STEP_COUNT >= 1,
+              "THERMOSTAT_PERIOD_MS must be a multiple of ESTIMATOR_PERIOD_MS");
+static_assert(KP_Q16 >= 0 && KP_Q16 * (int64_t)ERROR_LIMIT < TERM_LIMIT &&
+              KI_Q16 >= 0 && KI_Q16 * (int64_t)ERROR_LIMIT < TERM_LIMIT &&
+              KD_Q16 >= 0 && KD_Q16 * (int64_t)RATE_LIMIT < TERM_LIMIT,
+              "THERMOSTAT gains out of range");
+
+// ============================================================================
+// MODE AND GAIN SOURCE NAMES (flash)
+// ============================================================================
+
+static const char nameManual[] PROGMEM = "MANUAL";
+static const char nameAuto[] PROGMEM   = "AUTO";
+static const char nameTune[] PROGMEM   = "TUNE";
+static const char nameEco[] PROGMEM    = "ECO";
+
+// Indexed by ThermostatMode
+static const char* const modeNames[THERMOSTAT_MODE_COUNT] PROGMEM = { nameManual, nameAuto, nameTune, nameEco };
+
+static const char nameDefault[] PROGMEM = "DEFAULT";
+static const char nameTuned[] PROGMEM   = "TUNED";
+
+// Indexed by ThermostatGainSource
+static const char* const sourceNames[THERMOSTAT_GAINS_COUNT] PROGMEM = { nameDefault, nameTuned };
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static ThermostatMode mode = THERMOSTAT_MANUAL;
+static bool running = false;          // AUTO with the pump on since the last step
+static uint8_t stepsLeft = 0;
+static int32_t integral = 0;          // 16.16 duty
+static ThermostatGains gains = { KP_Q16, KI_Q16, KD_Q16 };
+static ThermostatGainSource gainSource = THERMOSTAT_GAINS_DEFAULT;
+
+// Settling time of the last AUTO start, per gain source
+static bool settling = false;
+static bool inBand = false;
+static uint32_t settleStartMs = 0;
+static uint32_t inBandSinceMs = 0;
+static uint32_t settleMs[THERMOSTAT_GAINS_COUNT] = { UNMEASURED, UNMEASURED };
+
+// Last step, for reporting
+static int16_t lastError = 0;
+static int32_t lastP = 0;
+static int32_t lastD = 0;
+static uint8_t lastDuty = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+// Hundredths as "<whole>.<hundredths>" (gains are never negative)
+static void formatHundredths(uint32_t value, char* buffer, size_t bufferSize) {
+  snprintf_P(buffer, bufferSize, PSTR("%lu.%02u"), value / 100, (unsigned)(value % 100));
+}
+
+// Copy a name out of one of the flash tables above
+static void copyName(const char* const* table, uint8_t index, char* buffer, size_t bufferSize) {
+  strncpy_P(buffer, (const char*)pgm_read_ptr(&table[index]), bufferSize - 1);
+  buffer[bufferSize - 1] = '\0';
+}
+
+// Time from the start of AUTO until the error entered the settle band for
+// good (it then has to stay there THERMOSTAT_SETTLE_HOLD_MS to count)
+static void trackSettling(int16_t error) {
+  if (!settling) {
+    return;
+  }
+
+  uint32_t now = millis();
+  if (abs(error) > SETTLE_BAND) {
+    inBand = false;
+  } else if (!inBand) {
+    inBand = true;
+    inBandSinceMs = now;
+  } else if (now - inBandSinceMs >= THERMOSTAT_SETTLE_HOLD_MS) {
+    settleMs[gainSource] = inBandSinceMs - settleStartMs;
+    settling = false;
+
+    #if DEBUG_MODE
+      DEBUG_SERIAL.print(F("[THERMO] Settled in "));
+      DEBUG_SERIAL.print(settleMs[gainSource] / 1000);
+      DEBUG_SERIAL.println(F(" s"));
+    #endif
+  }
+}
+
+// ============================================================================
+// THERMOSTAT
+// ============================================================================
+
+void thermostatInit() {
+  mode = THERMOSTAT_MANUAL;
+  running = false;
+  stepsLeft = 0;
+  integral = 0;
+  settling = false;
+}
+
+void thermostatSetMode(ThermostatMode newMode) {
+  if (newMode == mode) {
+    return;
+  }
+
+  if (mode == THERMOSTAT_TUNE) {
+    autotuneCancel();
+  }
+
+  mode = newMode;
+  running = false;                    // Next AUTO step starts bumpless
+  stepsLeft = 0;
+  if (mode == THERMOSTAT_ECO) {
+    ecoReset();
+  }
+
+  #if DEBUG_MODE
+    char name[THERMOSTAT_MODE_NAME_SIZE];
+    DEBUG_SERIAL.print(F("[THERMO] Mode: "));
+    DEBUG_SERIAL.println(thermostatGetModeName(mode, name, sizeof(name)));
+  #endif
+}
+
+ThermostatMode thermostatGetMode() {
+  return mode;
+}
+
+char* thermostatGetModeName(ThermostatMode m, char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < THERMOSTAT_MODE_NAME_SIZE) {
+    return NULL;
+  }
+
+  copyName(modeNames, (m < THERMOSTAT_MODE_COUNT) ? m : THERMOSTAT_MANUAL, buffer, bufferSize);
+  return buffer;
+}
+
+int16_t thermostatGetTarget() {
+  return TARGET;
+}
+
+void thermostatSetGains(const ThermostatGains& newGains, ThermostatGainSource source) {
+  gains.kp = constrain(newGains.kp, 0L, TERM_LIMIT / ERROR_LIMIT - 1);
+  gains.ki = constrain(newGains.ki, 0L, TERM_LIMIT / ERROR_LIMIT - 1);
+  gains.kd = constrain(newGains.kd, 0L, TERM_LIMIT / RATE_LIMIT - 1);
+  gainSource = source;
+  running = false;                    // Restart bumpless, and time the new gains from here
+}
+
+void thermostatResetGains() {
+  ThermostatGains defaults = { KP_Q16, KI_Q16, KD_Q16 };
+  thermostatSetGains(defaults, THERMOSTAT_GAINS_DEFAULT);
+}
+
+void thermostatUpdate(const ThermalEstimate& estimate) {
+  if (mode == THERMOSTAT_TUNE) {
+    running = false;
+    autotuneStep(estimate);
+    return;
+  }
+  if (mode == THERMOSTAT_ECO) {
+    running = false;
+    ecoStep(estimate);
+    return;
+  }
+  if (mode != THERMOSTAT_AUTO || pumpGetState() != PUMP_ON) {
+    running = false;
+    settling = false;
+    return;
+  }
+  if (stepsLeft > 0) {
+    stepsLeft--;
+    return;
+  }
+  stepsLeft = STEP_COUNT - 1;
+
+  int16_t error = constrain(estimate.skinTemp - TARGET, -ERROR_LIMIT, ERROR_LIMIT);
+  int16_t rate = constrain(estimate.skinRate, -RATE_LIMIT, RATE_LIMIT);
+  int32_t p = gains.kp * error;
+  int32_t d = gains.kd * rate;
+
+  if (!running) {
+    // Bumpless: start from the speed the pump already has
+    integral = constrain(((int32_t)pumpGetSpeed() << 16) - p - d, 0L, OUTPUT_MAX);
+    running = true;
+    settling = true;
+    inBand = false;
+    settleStartMs = millis();
+  } else {
+    // Anti-windup: no integration further into saturation
+    int32_t output = p + integral + d;
+    bool pushingHigh = (error > 0 && output >= OUTPUT_MAX);
+    bool pushingLow = (error < 0 && output <= 0);
+    if (!pushingHigh && !pushingLow) {
+      integral = constrain(integral + gains.ki * error, 0L, OUTPUT_MAX);
+    }
+  }
+
+  // Output to the pump at its full resolution (see pumppwm.h)
+  int32_t output = constrain(p + integral + d, 0L, OUTPUT_MAX);
+  uint8_t duty = (uint8_t)((output + 0x8000L) >> 16);
+  uint16_t level = (uint16_t)(((output >> 6) * PUMP_HIRES_MAX + (255L << 9)) / (255L << 10));
+  if (duty < THERMOSTAT_MIN_DUTY) {
+    duty = 0;
+    level = 0;
+  }
+
+  lastError = error;
+  lastP = p;
+  lastD = d;
+  lastDuty = duty;
+  trackSettling(error);
+
+  if (level != pumpGetSpeedHiRes()) {
+    pumpSetSpeedHiRes(level);
+  }
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* thermostatGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 112) {
+    return NULL;
+  }
+
+  char modeStr[THERMOSTAT_MODE_NAME_SIZE];
+  char sourceStr[8];
+  char targetStr[8];
+  char errorStr[8];
+  thermostatGetModeName(mode, modeStr, sizeof(modeStr));
+  copyName(sourceNames, gainSource, sourceStr, sizeof(sourceStr));
+  bluetoothFormatTemperature(TARGET, targetStr, sizeof(targetStr));
+  bluetoothFormatTemperature(lastError, errorStr, sizeof(errorStr));
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("MODE:{Mode:%s,Target:%sC,Error:%sC,P:%d,I:%d,D:%d,Duty:%u,Gains:%s}"),
+             modeStr, targetStr, errorStr,
+             (int)(lastP >> 16), (int)(integral >> 16), (int)(lastD >> 16), lastDuty,
+             sourceStr);
+  return buffer;
+}
+
+char* thermostatGetGainsString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 64) {
+    return NULL;
+  }
+
+  // Back from 16.16 per centi-degree (per m°C/s for D) to hundredths of
+  // duty per degree; 10000 / 65536 = 625 / 4096 keeps this in 32 bits
+  char sourceStr[8];
+  char kpStr[12];
+  char kiStr[12];
+  char kdStr[12];
+  copyName(sourceNames, gainSource, sourceStr, sizeof(sourceStr));
+  formatHundredths((uint32_t)gains.kp * 625 / 4096, kpStr, sizeof(kpStr));
+  formatHundredths((uint32_t)gains.ki * 625 / 4096 * 1000 / THERMOSTAT_PERIOD_MS, kiStr, sizeof(kiStr));
+  formatHundredths((uint32_t)gains.kd * 3125 / 2048, kdStr, sizeof(kdStr));
+
+  snprintf_P(buffer, bufferSize, PSTR("GAINS:{Source:%s,Kp:%s,Ki:%s,Kd:%s}"),
+             sourceStr, kpStr, kiStr, kdStr);
+  return buffer;
+}
+
+char* thermostatGetSettleString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 40) {
+    return NULL;
+  }
+
+  char settleStr[THERMOSTAT_GAINS_COUNT][12];
+  for (uint8_t i = 0; i < THERMOSTAT_GAINS_COUNT; i++) {
+    if (settleMs[i] == UNMEASURED) {
+      strcpy_P(settleStr[i], PSTR("-"));
+    } else {
+      snprintf_P(settleStr[i], sizeof(settleStr[i]), PSTR("%lus"), settleMs[i] / 1000);
+    }
+  }
+
+  snprintf_P(buffer, bufferSize, PSTR("SETTLE:{Default:%s,Tuned:%s}"),
+             settleStr[THERMOSTAT_GAINS_DEFAULT], settleStr[THERMOSTAT_GAINS_TUNED]);
+  return buffer;
+}
@@ -0,0 +1,153 @@
+/*
+ * thermostat.h
+ * Closed-loop skin temperature control header for Testicool device
+ *
+ * In AUTO mode a PID controller sets the pump speed from the estimated
+ * skin temperature (estimator.h), aiming for the middle of the
+ * TARGET_TEMP_MIN_C..TARGET_TEMP_MAX_C band. Compared with a fixed
+ * PUMP_DEFAULT_SPEED it runs the pump only as hard as the band needs,
+ * which spares the ice and the battery. In MANUAL mode (the default) the
+ * speed comes from the pot, the app or PUMP_DEFAULT_SPEED as before.
+ *
+ * The controller only acts while the pump is ON; ON/OFF, the runtime
+ * limit and the overheat cutoff work the same in every mode. ECO mode
+ * (eco.h) pulses the pump instead of running the PID.
+ *
+ * Fixed point, one step every THERMOSTAT_PERIOD_MS:
+ * - P on the error (centi-degrees), D on the estimator's skin rate
+ *   (already filtered, and no kick when the target changes)
+ * - I accumulated in 16.16 duty units; it stops integrating while the
+ *   output is saturated in the direction of the error and is clamped to
+ *   the duty range (anti-windup)
+ * - Output clamped to 0..PUMP_MAX_SPEED; below THERMOSTAT_MIN_DUTY the
+ *   pump is set to 0 rather than left stalled
+ * - Switching to AUTO with the pump running preloads the integrator so
+ *   the speed does not jump (bumpless transfer)
+ *
+ * The gains start from THERMOSTAT_KP/KI/KD; the relay autotuner
+ * (autotune.h, TUNE mode) replaces them with gains measured on the wearer
+ * and keeps those in EEPROM. Each AUTO start is timed until the skin has
+ * stayed within half the band of the target for THERMOSTAT_SETTLE_HOLD_MS,
+ * per gain set, so default and tuned settling can be compared.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef THERMOSTAT_H
+#define THERMOSTAT_H
+
+#include <Arduino.h>
+#include "estimator.h"
+
+// Who sets the pump speed
+enum ThermostatMode {
+  THERMOSTAT_MANUAL = 0,     // Pot, SPEED command, PUMP_DEFAULT_SPEED
+  THERMOSTAT_AUTO,           // PID on skin temperature
+  THERMOSTAT_TUNE,           // Relay autotuner running (autotune.h)
+  THERMOSTAT_ECO,            // Pulsed pump on skin hysteresis (eco.h)
+  THERMOSTAT_MODE_COUNT
+};
+
+#define THERMOSTAT_MODE_NAME_SIZE  8   // Longest mode name + terminator
+
+// Where the gains in use came from
+enum ThermostatGainSource {
+  THERMOSTAT_GAINS_DEFAULT = 0,   // config.h
+  THERMOSTAT_GAINS_TUNED,         // Autotuner (now or from EEPROM)
+  THERMOSTAT_GAINS_COUNT
+};
+
+// PID gains in 16.16 pump duty per unit of the input they multiply
+struct ThermostatGains {
+  int32_t kp;                // Per centi-degree of error
+  int32_t ki;                // Per centi-degree of error, per THERMOSTAT_PERIOD_MS step
+  int32_t kd;                // Per m°C/s of skin rise
+};
+
+// ============================================================================
+// THERMOSTAT FUNCTIONS
+// ============================================================================
+
+/**
+ * Start in MANUAL mode
+ * Call once in setup()
+ */
+void thermostatInit();
+
+/**
+ * Select the mode
+ * Leaving TUNE stops a running autotune
+ * @param mode: ThermostatMode
+ */
+void thermostatSetMode(ThermostatMode mode);
+
+/**
+ * Get the current mode
+ * @return ThermostatMode
+ */
+ThermostatMode thermostatGetMode();
+
+/**
+ * Copy the protocol name of a mode: "MANUAL", "AUTO", "TUNE" or "ECO"
+ * @param mode: ThermostatMode
+ * @param buffer: character array to store the name
+ * @param bufferSize: size of buffer array, at least THERMOSTAT_MODE_NAME_SIZE
+ * @return pointer to buffer, NULL if it is too small
+ */
+char* thermostatGetModeName(ThermostatMode mode, char* buffer, size_t bufferSize);
+
+/**
+ * Get the target skin temperature (middle of the target band)
+ * @return hundredths of a degree
+ */
+int16_t thermostatGetTarget();
+
+/**
+ * Replace the gains (limited to what the fixed-point terms can carry)
+ * @param gains: new gains
+ * @param source: ThermostatGainSource
+ */
+void thermostatSetGains(const ThermostatGains& gains, ThermostatGainSource source);
+
+/**
+ * Return to the config.h gains
+ */
+void thermostatResetGains();
+
+/**
+ * Get the gains in use as formatted string, in engineering units
+ * Format: "GAINS:{Source:<DEFAULT|TUNED>,Kp:<duty/C>,Ki:<duty/C/s>,Kd:<duty/(C/s)>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* thermostatGetGainsString(char* buffer, size_t bufferSize);
+
+/**
+ * Run the controller (every THERMOSTAT_PERIOD_MS; calls in between return)
+ * Called on every estimator step (POT task); sets the pump speed in AUTO,
+ * steps the autotuner in TUNE and the pulse control in ECO
+ * @param estimate: latest thermal estimate
+ */
+void thermostatUpdate(const ThermalEstimate& estimate);
+
+/**
+ * Get the controller state as formatted string
+ * Format: "MODE:{Mode:<mode>,Target:<C>,Error:<C>,P:<duty>,I:<duty>,D:<duty>,Duty:<0-255>,Gains:<DEFAULT|TUNED>}"
+ * (terms are those of the last AUTO step)
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* thermostatGetStatusString(char* buffer, size_t bufferSize);
+
+/**
+ * Format the last measured settling time of each gain set
+ * Format: "SETTLE:{Default:<s>,Tuned:<s>}" ("-" until measured)
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* thermostatGetSettleString(char* buffer, size_t bufferSize);
+
+#endif // THERMOSTAT_H
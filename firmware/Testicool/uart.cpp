@@ -0,0 +1,327 @@
+/*
+ * uart.cpp
+ * Interrupt-driven hardware UART driver implementation for Testicool device
+ *
+ * Output rings (SAFETY, REPLY, DEBUG) use free-running byte indices:
+ * - The main context copies a line in at `fill`, then publishes it by
+ *   moving `head` (a single byte store, so the ISR sees all of it or none)
+ * - The UDRE interrupt sends from `tail` up to `head`
+ * TELEMETRY is double-buffered instead: the interrupt sends one buffer
+ * while the main context writes the other; a line that is still pending
+ * when the next one arrives is overwritten (coalesced).
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "uart.h"
+
+#if !USE_SOFTWARE_SERIAL
+
+#include "cmdqueue.h"
+#include <util/atomic.h>
+
+#define TX_NONE  0xFF
+
+static_assert(UART_TX_SAFETY_SIZE <= 128 && (UART_TX_SAFETY_SIZE & (UART_TX_SAFETY_SIZE - 1)) == 0 &&
+              UART_TX_REPLY_SIZE <= 128 && (UART_TX_REPLY_SIZE & (UART_TX_REPLY_SIZE - 1)) == 0 &&
+              UART_TX_DEBUG_SIZE <= 128 && (UART_TX_DEBUG_SIZE & (UART_TX_DEBUG_SIZE - 1)) == 0,
+              "UART_TX ring sizes must be powers of two <= 128");
+
+UartPort BtUart;
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+struct TxRing {
+  uint8_t* data;
+  uint8_t mask;               // Size - 1
+  volatile uint8_t head;      // End of published lines (main)
+  volatile uint8_t tail;      // Next byte to send (UDRE ISR)
+  uint8_t fill;               // End of bytes written so far (main, >= head)
+};
+
+static uint8_t safetyData[UART_TX_SAFETY_SIZE];
+static uint8_t replyData[UART_TX_REPLY_SIZE];
+static TxRing safetyRing = { safetyData, UART_TX_SAFETY_SIZE - 1, 0, 0, 0 };
+static TxRing replyRing = { replyData, UART_TX_REPLY_SIZE - 1, 0, 0, 0 };
+
+#if DEBUG_MODE
+  static uint8_t debugData[UART_TX_DEBUG_SIZE];
+  static TxRing debugRing = { debugData, UART_TX_DEBUG_SIZE - 1, 0, 0, 0 };
+  static bool debugDiscarding = false;    // Current debug line did not fit
+#endif
+
+static char telemetry[2][UART_TX_TELEMETRY_SIZE];
+static volatile uint8_t telemetryPending = TX_NONE;   // Buffer waiting to be sent
+static volatile uint8_t telemetrySending = TX_NONE;   // Buffer the ISR is sending
+static uint8_t telemetryPos = 0;                      // ISR read position
+
+static uint8_t activeClass = TX_NONE;   // Class of the line being sent (ISR only)
+
+// Statistics
+static volatile unsigned long rxBytes = 0;
+static volatile uint16_t frameErrors = 0;
+static volatile uint16_t overruns = 0;
+static uint16_t txDropped[UART_TX_CLASS_COUNT];
+static uint16_t txCoalesced = 0;
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static TxRing* ringFor(uint8_t txClass) {
+  switch (txClass) {
+    case UART_TX_SAFETY: return &safetyRing;
+    case UART_TX_REPLY:  return &replyRing;
+    #if DEBUG_MODE
+      case UART_TX_DEBUG:  return &debugRing;
+    #endif
+    default:             return NULL;
+  }
+}
+
+static uint8_t ringFree(const TxRing& ring) {
+  return (uint8_t)(ring.mask + 1 - (uint8_t)(ring.fill - ring.tail));
+}
+
+static void countDrop(uint8_t txClass) {
+  if (txDropped[txClass] < 0xFFFF) {
+    txDropped[txClass]++;
+  }
+}
+
+// Start the UDRE interrupt (it stops itself when everything is sent)
+static void startTx() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    UCSR0B |= _BV(UDRIE0);
+  }
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void uartInit(unsigned long baud) {
+  // Double speed mode: 0.2% error at 9600 baud from 16 MHz
+  UCSR0A = _BV(U2X0);
+  UBRR0 = (uint16_t)((F_CPU / 4 / baud - 1) / 2);
+  UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);                    // 8N1
+  UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0);        // UDRIE0 set on demand
+}
+
+// ============================================================================
+// INTERRUPT HANDLERS
+// ============================================================================
+
+ISR(USART_RX_vect) {
+  uint8_t status = UCSR0A;   // Error flags must be read before UDR0
+  uint8_t data = UDR0;
+
+  if (status & _BV(FE0)) {
+    if (frameErrors < 0xFFFF) {
+      frameErrors++;
+    }
+    return;
+  }
+  if ((status & _BV(DOR0)) && overruns < 0xFFFF) {
+    overruns++;
+  }
+
+  rxBytes++;
+  cmdQueueReceive((char)data);
+}
+
+// Highest-priority class with a complete line waiting
+static uint8_t pickNextClass() {
+  if (safetyRing.tail != safetyRing.head) {
+    return UART_TX_SAFETY;
+  }
+  if (replyRing.tail != replyRing.head) {
+    return UART_TX_REPLY;
+  }
+  if (telemetryPending != TX_NONE) {
+    telemetrySending = telemetryPending;
+    telemetryPending = TX_NONE;
+    telemetryPos = 0;
+    return UART_TX_TELEMETRY;
+  }
+  #if DEBUG_MODE
+    if (debugRing.tail != debugRing.head) {
+      return UART_TX_DEBUG;
+    }
+  #endif
+  return TX_NONE;
+}
+
+ISR(USART_UDRE_vect) {
+  if (activeClass == TX_NONE) {
+    activeClass = pickNextClass();
+    if (activeClass == TX_NONE) {
+      UCSR0B &= ~_BV(UDRIE0);   // Nothing left - stop until the next line
+      return;
+    }
+  }
+
+  uint8_t byte;
+  if (activeClass == UART_TX_TELEMETRY) {
+    byte = telemetry[telemetrySending][telemetryPos++];
+  } else {
+    TxRing* ring = ringFor(activeClass);
+    byte = ring->data[ring->tail & ring->mask];
+    ring->tail++;
+  }
+  UDR0 = byte;
+
+  // Line complete - the next byte may come from a higher-priority class
+  if (byte == '\n') {
+    if (activeClass == UART_TX_TELEMETRY) {
+      telemetrySending = TX_NONE;
+    }
+    activeClass = TX_NONE;
+  }
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+static bool queueTelemetry(const char* text, size_t length) {
+  if (length + 2 > UART_TX_TELEMETRY_SIZE) {
+    countDrop(UART_TX_TELEMETRY);
+    return false;
+  }
+
+  // Reuse the pending buffer (coalesce), else take the one not being sent
+  uint8_t buffer;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (telemetryPending != TX_NONE) {
+      buffer = telemetryPending;
+      telemetryPending = TX_NONE;
+      if (txCoalesced < 0xFFFF) {
+        txCoalesced++;
+      }
+    } else {
+      buffer = (telemetrySending == 0) ? 1 : 0;
+    }
+  }
+
+  memcpy(telemetry[buffer], text, length);
+  telemetry[buffer][length] = '\r';
+  telemetry[buffer][length + 1] = '\n';
+
+  telemetryPending = buffer;
+  startTx();
+  return true;
+}
+
+bool uartSendLine(uint8_t txClass, const char* text) {
+  if (txClass >= UART_TX_CLASS_COUNT || text == NULL) {
+    return false;
+  }
+
+  size_t length = strlen(text);
+  if (txClass == UART_TX_TELEMETRY) {
+    return queueTelemetry(text, length);
+  }
+
+  TxRing* ring = ringFor(txClass);
+  if (ring == NULL) {
+    return false;   // DEBUG class without DEBUG_MODE
+  }
+
+  #if DEBUG_MODE
+    if (ring == &debugRing && ring->fill != ring->head) {
+      countDrop(txClass);   // A DEBUG_SERIAL print is half way through a line
+      return false;
+    }
+  #endif
+
+  if (length + 2 > ringFree(*ring)) {
+    countDrop(txClass);
+    return false;
+  }
+
+  while (*text) {
+    ring->data[ring->fill++ & ring->mask] = *text++;
+  }
+  ring->data[ring->fill++ & ring->mask] = '\r';
+  ring->data[ring->fill++ & ring->mask] = '\n';
+
+  ring->head = ring->fill;   // Publish the whole line at once
+  startTx();
+  return true;
+}
+
+uint8_t uartGetTxFree(uint8_t txClass) {
+  const TxRing* ring = ringFor(txClass);
+  return ring ? ringFree(*ring) : 0;
+}
+
+// DEBUG_SERIAL output: bytes collect until '\n', then the line is published
+size_t UartPort::write(uint8_t byte) {
+  #if DEBUG_MODE
+    if (debugDiscarding) {
+      debugDiscarding = (byte != '\n');
+      return 1;
+    }
+
+    if (ringFree(debugRing) == 0) {
+      debugRing.fill = debugRing.head;   // Line too long for the ring - drop it whole
+      countDrop(UART_TX_DEBUG);
+      debugDiscarding = (byte != '\n');
+      return 1;
+    }
+
+    debugRing.data[debugRing.fill++ & debugRing.mask] = byte;
+    if (byte == '\n') {
+      debugRing.head = debugRing.fill;
+      startTx();
+    }
+  #else
+    (void)byte;
+  #endif
+  return 1;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void uartGetStats(UartStats* stats) {
+  if (stats == NULL) {
+    return;
+  }
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    stats->rxBytes = rxBytes;
+    stats->frameErrors = frameErrors;
+    stats->overruns = overruns;
+  }
+  memcpy(stats->txDropped, txDropped, sizeof(txDropped));
+  stats->txCoalesced = txCoalesced;
+}
+
+char* uartGetStatusString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 80) {
+    return NULL;
+  }
+
+  UartStats stats;
+  uartGetStats(&stats);
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("UART:{RxBytes:%lu,FrameErr:%u,Overrun:%u,TxDrop:%u/%u/%u/%u,Coalesced:%u}"),
+             stats.rxBytes,
+             stats.frameErrors,
+             stats.overruns,
+             stats.txDropped[UART_TX_SAFETY],
+             stats.txDropped[UART_TX_REPLY],
+             stats.txDropped[UART_TX_TELEMETRY],
+             stats.txDropped[UART_TX_DEBUG],
+             stats.txCoalesced);
+
+  return buffer;
+}
+
+#endif // !USE_SOFTWARE_SERIAL
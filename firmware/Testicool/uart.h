@@ -0,0 +1,114 @@
+/*
+ * uart.h
+ * Interrupt-driven hardware UART driver header for Testicool device
+ *
+ * Replaces the Arduino core's HardwareSerial on D0/D1 (Bluetooth module):
+ * - The RX interrupt hands every byte straight to the command line
+ *   assembler (cmdqueue.h) instead of a 64-byte ring that loop() polls
+ * - Output is queued as whole lines in priority classes and sent by the
+ *   UDRE interrupt; nothing ever waits for the UART
+ *
+ * Output classes, highest priority first:
+ * - SAFETY:    safety events (OVERHEAT, SAFETY_SHUTOFF, ...)
+ * - REPLY:     command replies and state change notifications
+ * - TELEMETRY: periodic status; one pending line, a newer one replaces it
+ * - DEBUG:     DEBUG_SERIAL prints (only with DEBUG_MODE)
+ * A line, once started, is always sent to its end before the next class
+ * is chosen, so lines of different classes never interleave. A line that
+ * does not fit its class buffer is dropped whole and counted.
+ *
+ * The core defines the same USART interrupt vectors in HardwareSerial0.cpp,
+ * which is only linked in when `Serial` is used. With the hardware UART
+ * nothing may reference `Serial`: debug prints use DEBUG_SERIAL, which is
+ * BtUart here and the real Serial when the Bluetooth module sits on
+ * SoftwareSerial (then this driver compiles out).
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if !USE_SOFTWARE_SERIAL
+
+// Output priority classes (lower value = sent first)
+enum UartTxClass {
+  UART_TX_SAFETY = 0,
+  UART_TX_REPLY,
+  UART_TX_TELEMETRY,
+  UART_TX_DEBUG,
+  UART_TX_CLASS_COUNT
+};
+
+// Receive error and output queue statistics
+struct UartStats {
+  unsigned long rxBytes;     // Bytes handed to the line assembler
+  uint16_t frameErrors;      // Bytes discarded with a framing error
+  uint16_t overruns;         // Hardware data overruns (byte lost before the ISR ran)
+  uint16_t txDropped[UART_TX_CLASS_COUNT];  // Lines dropped per class (buffer full)
+  uint16_t txCoalesced;      // Telemetry lines replaced by a newer one before sending
+};
+
+// Print-compatible output on the hardware UART (DEBUG class, line-buffered)
+class UartPort : public Print {
+ public:
+  size_t write(uint8_t byte) override;
+  using Print::write;
+};
+
+extern UartPort BtUart;
+
+#define DEBUG_SERIAL BtUart
+
+// ============================================================================
+// UART FUNCTIONS
+// ============================================================================
+
+/**
+ * Configure USART0 (8N1, double speed) and enable its interrupts
+ * @param baud: baud rate
+ */
+void uartInit(unsigned long baud);
+
+/**
+ * Queue one line for output (a line ending is appended)
+ * Never blocks. TELEMETRY replaces a telemetry line that has not started sending.
+ * @param txClass: UartTxClass
+ * @param text: line without line ending
+ * @return true if queued, false if dropped (no room)
+ */
+bool uartSendLine(uint8_t txClass, const char* text);
+
+/**
+ * Get free space in the buffer of an output class
+ * Used to pace multi-line reports instead of dropping their lines
+ * @param txClass: UART_TX_SAFETY, UART_TX_REPLY or UART_TX_DEBUG
+ * @return free bytes (a line needs its length + 2)
+ */
+uint8_t uartGetTxFree(uint8_t txClass);
+
+/**
+ * Get receive and output queue statistics
+ * @param stats: structure to fill
+ */
+void uartGetStats(UartStats* stats);
+
+/**
+ * Format receive and output queue statistics
+ * Format: "UART:{RxBytes:<n>,FrameErr:<n>,Overrun:<n>,TxDrop:<safety>/<reply>/<telemetry>/<debug>,Coalesced:<n>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* uartGetStatusString(char* buffer, size_t bufferSize);
+
+#else
+
+#define DEBUG_SERIAL Serial
+
+#endif // !USE_SOFTWARE_SERIAL
+
+#endif // UART_H
@@ -0,0 +1,294 @@
+/*
+ * watchdog.cpp
+ * Watchdog and loop-overrun detector implementation for Testicool device
+ *
+ * The watchdog runs in interrupt + reset mode: the first timeout calls
+ * WDT_vect (hardware then clears WDIE), which makes the pump safe, logs
+ * the stall and switches to the shortest reset-only timeout.
+ *
+ * After a watchdog reset the watchdog stays enabled with its shortest
+ * timeout, so it is switched off from .init3, before the C runtime even
+ * clears .bss, and MCUSR is saved there for the reset cause.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include "watchdog.h"
+#include "config.h"
+#include "uart.h"
+#include "scheduler.h"
+#include "pump.h"
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+#define STALL_LOG_MAGIC   0x57A1
+
+// Watchdog prescaler steps (WDTO_15MS .. WDTO_8S)
+static const uint16_t timeoutStepsMs[] = { 15, 30, 60, 120, 250, 500, 1000, 2000, 4000, 8000 };
+#define TIMEOUT_STEP_COUNT  (sizeof(timeoutStepsMs) / sizeof(timeoutStepsMs[0]))
+
+// ============================================================================
+// PERSISTENT STALL LOG (.noinit - survives watchdog and external resets)
+// ============================================================================
+
+struct StallLog {
+  uint16_t magic;
+  uint8_t head;               // Next slot to write
+  uint8_t count;              // Valid records
+  uint8_t bootCount;          // Incremented on every boot
+  uint8_t watchdogResets;     // Boots that followed a watchdog stall
+  uint8_t watchdogFired;      // Set by WDT_vect just before the reset
+  uint16_t overruns;          // Software overruns detected (saturates)
+  StallRecord records[STALL_LOG_SIZE];
+};
+
+static StallLog stallLog __attribute__((section(".noinit")));
+static uint8_t resetFlags __attribute__((section(".noinit")));  // MCUSR at startup
+
+// ============================================================================
+// PRIVATE VARIABLES
+// ============================================================================
+
+static bool lastResetWasWatchdog = false;
+static uint16_t timeoutMs = 0;                  // 0 = watchdog not armed
+static volatile unsigned long lastKickUs = 0;
+
+// ============================================================================
+// EARLY STARTUP
+// ============================================================================
+
+// Runs from the startup code before main(); naked + .init3 means no call/return
+static void watchdogEarlyInit() __attribute__((naked, used, section(".init3")));
+static void watchdogEarlyInit() {
+  resetFlags = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+// ============================================================================
+// PRIVATE HELPERS
+// ============================================================================
+
+static void clearLog() {
+  memset(&stallLog, 0, sizeof(stallLog));
+  stallLog.magic = STALL_LOG_MAGIC;
+}
+
+// Append a record, overwriting the oldest when full (interrupts disabled)
+static void appendRecord(uint8_t kind, uint8_t task, unsigned long durationUs) {
+  StallRecord& rec = stallLog.records[stallLog.head];
+  rec.boot = stallLog.bootCount;
+  rec.kind = kind;
+  rec.task = task;
+  rec.timeMs = millis();
+  rec.durationUs = durationUs;
+
+  stallLog.head = (stallLog.head + 1) % STALL_LOG_SIZE;
+  if (stallLog.count < STALL_LOG_SIZE) {
+    stallLog.count++;
+  }
+}
+
+// Longest gap between two kicks: a task running up to its deadline,
+// plus an idle sleep of up to the shortest task period
+static uint16_t computeBudgetMs() {
+  uint16_t maxDeadline = 0;
+  uint16_t minPeriod = 0xFFFF;
+
+  for (uint8_t i = 0; i < schedulerGetTaskCount(); i++) {
+    const SchedulerTask* task = schedulerGetTask(i);
+    if (task->deadlineMs > maxDeadline) {
+      maxDeadline = task->deadlineMs;
+    }
+    if (task->periodMs != 0 && task->periodMs < minPeriod) {
+      minPeriod = task->periodMs;
+    }
+  }
+  if (minPeriod == 0xFFFF) {
+    minPeriod = 0;
+  }
+
+  return maxDeadline + minPeriod;
+}
+
+// Flash string
+static PGM_P resetCauseString(uint8_t flags) {
+  if (flags & _BV(WDRF))  return PSTR("WDT");
+  if (flags & _BV(BORF))  return PSTR("BOR");
+  if (flags & _BV(EXTRF)) return PSTR("EXT");
+  if (flags & _BV(PORF))  return PSTR("POR");
+  return PSTR("?");   // Cleared by the bootloader
+}
+
+// ============================================================================
+// WATCHDOG INITIALIZATION
+// ============================================================================
+
+void watchdogInit() {
+  // RAM content is random after power-on; otherwise trust the log if it checks out
+  bool valid = stallLog.magic == STALL_LOG_MAGIC &&
+               stallLog.head < STALL_LOG_SIZE &&
+               stallLog.count <= STALL_LOG_SIZE;
+  if (!valid || (resetFlags & _BV(PORF))) {
+    clearLog();
+  }
+
+  stallLog.bootCount++;
+  lastResetWasWatchdog = (stallLog.watchdogFired != 0);
+  if (lastResetWasWatchdog) {
+    stallLog.watchdogFired = 0;
+    stallLog.watchdogResets++;
+  }
+
+  #if WATCHDOG_ENABLED
+    // Add 25% for the tolerance of the 128 kHz watchdog oscillator
+    uint16_t budgetMs = computeBudgetMs();
+    uint32_t neededMs = (uint32_t)budgetMs + budgetMs / 4;
+
+    uint8_t step = 0;
+    while (step < TIMEOUT_STEP_COUNT - 1 && timeoutStepsMs[step] < neededMs) {
+      step++;
+    }
+    timeoutMs = timeoutStepsMs[step];
+
+    uint8_t prescaler = (step & 0x07) | ((step & 0x08) ? _BV(WDP3) : 0);
+
+    lastKickUs = micros();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      wdt_reset();
+      WDTCSR = _BV(WDCE) | _BV(WDE);                        // Timed change sequence
+      WDTCSR = _BV(WDIE) | _BV(WDE) | prescaler;            // Interrupt, then reset
+    }
+
+    #if DEBUG_MODE
+      DEBUG_SERIAL.print(F("[WDT] Armed - Timeout: "));
+      DEBUG_SERIAL.print(timeoutMs);
+      DEBUG_SERIAL.print(F("ms, Reset cause: "));
+      DEBUG_SERIAL.println(reinterpret_cast<const __FlashStringHelper*>(resetCauseString(resetFlags)));
+    #endif
+  #endif
+}
+
+void watchdogKick() {
+  wdt_reset();
+  lastKickUs = micros();
+}
+
+bool watchdogWasReset() {
+  return lastResetWasWatchdog;
+}
+
+// ============================================================================
+// STALL DETECTION
+// ============================================================================
+
+void watchdogRecordOverrun(uint8_t task, unsigned long durationUs) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    appendRecord(STALL_OVERRUN, task, durationUs);
+    if (stallLog.overruns < 0xFFFF) {
+      stallLog.overruns++;
+    }
+  }
+}
+
+// First watchdog timeout: the loop has not kicked for a whole timeout
+ISR(WDT_vect) {
+  // Pump first - everything after this is bookkeeping
+  pumpForceSafe();
+
+  unsigned long sinceUs;
+  uint8_t task = schedulerGetRunningTask(&sinceUs);
+  if (task == SCHEDULER_NO_TASK) {
+    sinceUs = lastKickUs;   // Stuck outside the tasks - report time since the last kick
+  }
+
+  appendRecord(STALL_WATCHDOG, task, micros() - sinceUs);
+  stallLog.watchdogFired = 1;
+
+  // Reset as soon as possible instead of waiting another full timeout
+  WDTCSR = _BV(WDCE) | _BV(WDE);
+  WDTCSR = _BV(WDE);                                         // 15 ms, reset only
+  for (;;) {
+  }
+}
+
+// ============================================================================
+// STALL LOG ACCESS
+// ============================================================================
+
+uint8_t watchdogGetRecordCount() {
+  return stallLog.count;
+}
+
+bool watchdogGetRecord(uint8_t index, StallRecord* record) {
+  if (index >= stallLog.count || record == NULL) {
+    return false;
+  }
+
+  // Oldest record sits `count` slots behind head
+  uint8_t slot = (stallLog.head + STALL_LOG_SIZE - stallLog.count + index) % STALL_LOG_SIZE;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    *record = stallLog.records[slot];
+  }
+  return true;
+}
+
+void watchdogClearRecords() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    uint8_t boot = stallLog.bootCount;
+    clearLog();
+    stallLog.bootCount = boot;
+  }
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+char* watchdogGetSummaryString(char* buffer, size_t bufferSize) {
+  if (buffer == NULL || bufferSize < 80) {
+    return NULL;
+  }
+
+  char cause[4];
+  strncpy_P(cause, resetCauseString(resetFlags), sizeof(cause) - 1);
+  cause[sizeof(cause) - 1] = '\0';
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("STALLS:{Boots:%u,WdtResets:%u,Overruns:%u,Reset:%s,Timeout:%ums,Count:%u}"),
+             stallLog.bootCount,
+             stallLog.watchdogResets,
+             stallLog.overruns,
+             cause,
+             timeoutMs,
+             stallLog.count);
+
+  return buffer;
+}
+
+char* watchdogGetRecordString(uint8_t index, char* buffer, size_t bufferSize) {
+  StallRecord rec;
+  if (buffer == NULL || bufferSize < 60 || !watchdogGetRecord(index, &rec)) {
+    return NULL;
+  }
+
+  // Task index refers to the task table of the current firmware
+  char taskName[SCHEDULER_TASK_NAME_SIZE];
+  if (schedulerGetTaskName(rec.task, taskName, sizeof(taskName)) == NULL) {
+    strcpy_P(taskName, PSTR("LOOP"));
+  }
+
+  char kind[8];
+  strncpy_P(kind, (rec.kind == STALL_WATCHDOG) ? PSTR("WDT") : PSTR("OVERRUN"), sizeof(kind) - 1);
+  kind[sizeof(kind) - 1] = '\0';
+
+  snprintf_P(buffer, bufferSize,
+             PSTR("STALL:Boot:%u,Task:%s,Kind:%s,T:%lums,Dur:%luus"),
+             rec.boot,
+             taskName,
+             kind,
+             rec.timeMs,
+             rec.durationUs);
+
+  return buffer;
+}
@@ -0,0 +1,111 @@
+/*
+ * watchdog.h
+ * Watchdog and loop-overrun detector header for Testicool device
+ *
+ * Two layers catch a stalled main loop:
+ * - Software overrun detector: the scheduler measures every task run and
+ *   records the task if it ran longer than its own deadline
+ * - Hardware watchdog: armed with a timeout derived from the task table
+ *   and kicked from loop(). If the loop stops kicking, the watchdog
+ *   interrupt first forces the pump outputs OFF and records the task that
+ *   was running, then the next timeout resets the MCU.
+ *
+ * Records (boot number, time, task, duration) go into a small ring in
+ * .noinit RAM, which is not cleared by a watchdog or external reset, so
+ * the STALLS command can report stalls that happened before the last
+ * reset. The ring is cleared on power-on.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <Arduino.h>
+
+// Kind of stall record
+enum StallKind {
+  STALL_OVERRUN = 0,     // Task ran longer than its deadline (software detector)
+  STALL_WATCHDOG = 1     // Loop stopped kicking the watchdog (followed by a reset)
+};
+
+// One stall record, as read back by watchdogGetRecord()
+struct StallRecord {
+  uint8_t boot;              // Boot number the stall happened in (wraps at 256)
+  uint8_t kind;              // StallKind
+  uint8_t task;              // Scheduler task index, SCHEDULER_NO_TASK if outside any task
+  unsigned long timeMs;      // millis() at detection
+  unsigned long durationUs;  // How long the task had been running
+};
+
+// ============================================================================
+// WATCHDOG FUNCTIONS
+// ============================================================================
+
+/**
+ * Validate the persistent stall log and arm the watchdog
+ * The timeout is the longest task deadline plus the shortest task period
+ * (worst case between two kicks), plus margin, rounded up to a watchdog step
+ * Call this function once in setup(), after schedulerInit()
+ */
+void watchdogInit();
+
+/**
+ * Reset the watchdog timer
+ * Call this function on every pass of loop()
+ */
+void watchdogKick();
+
+/**
+ * Check whether the previous reset was caused by this watchdog
+ * @return true if the last boot ended in a watchdog stall
+ */
+bool watchdogWasReset();
+
+/**
+ * Record a task that ran longer than its deadline
+ * Called by the scheduler after each task run
+ * @param task: scheduler task index
+ * @param durationUs: execution time of the run
+ */
+void watchdogRecordOverrun(uint8_t task, unsigned long durationUs);
+
+/**
+ * Get number of records in the stall log
+ * @return record count (at most STALL_LOG_SIZE)
+ */
+uint8_t watchdogGetRecordCount();
+
+/**
+ * Read a record from the stall log
+ * @param index: 0 = oldest record
+ * @param record: structure to fill
+ * @return true if index was valid
+ */
+bool watchdogGetRecord(uint8_t index, StallRecord* record);
+
+/**
+ * Clear the stall log and its counters
+ */
+void watchdogClearRecords();
+
+/**
+ * Format the stall log summary
+ * Format: "STALLS:{Boots:<n>,WdtResets:<n>,Overruns:<n>,Reset:<cause>,Timeout:<ms>ms,Count:<n>}"
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer
+ */
+char* watchdogGetSummaryString(char* buffer, size_t bufferSize);
+
+/**
+ * Format one stall record
+ * Format: "STALL:Boot:<n>,Task:<name>,Kind:<OVERRUN|WDT>,T:<ms>ms,Dur:<us>us"
+ * @param index: 0 = oldest record
+ * @param buffer: character array to store the string
+ * @param bufferSize: size of buffer array
+ * @return pointer to buffer, NULL if index is out of range
+ */
+char* watchdogGetRecordString(uint8_t index, char* buffer, size_t bufferSize);
+
+#endif // WATCHDOG_H
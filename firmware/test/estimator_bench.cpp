@@ -0,0 +1,215 @@
+/*
+ * estimator_bench.cpp
+ * Host benchmark: estimator noise and lag against the raw readings
+ *
+ * Runs estimator.cpp on simulated skin/water temperatures with Gaussian
+ * reading noise of ESTIMATOR_SENSOR_NOISE_C, quantized to 0.01°C like the
+ * snapshot, at the step periods the control step uses. Each scenario is
+ * compared with the raw readings and with an EMA using the estimator's own
+ * position gain (alpha), which smooths about as much but has no rate.
+ *
+ *   STEADY   pump off, temperatures constant          -> noise (RMS error)
+ *   RAMP     pump off, skin warming 1.2°C/min         -> lag (mean error / rate)
+ *   PUMP     pump starts at full speed on warm skin   -> tracking through the start
+ *   OVERHEAT skin warming slowly through 40°C         -> detection time at the threshold
+ *
+ * Fails if the estimate is noisier than the raw readings, or lags a ramp
+ * more than the EMA does.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "estimator.h"
+
+#define SIM_STEP_S        0.01    // Truth integration step
+#define SETTLE_S          60.0    // Not scored while the estimate starts up
+#define RAMP_C_PER_S      0.02
+#define BODY_HEAT_C_PER_S 0.01    // Skin warming with the pump off (PUMP, OVERHEAT)
+#define SEED              20261016UL
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+struct Scenario {
+  const char* name;
+  double durationS;
+  double skin;              // Initial truth, °C
+  double water;
+  double skinHeat;          // °C/s before pump cooling
+  double pumpOnS;           // Pump at full speed from this time (< 0: never)
+};
+
+struct Score {
+  double sumSq;
+  double sum;
+  unsigned long count;
+};
+
+struct Result {
+  Score raw;
+  Score ema;
+  Score est;
+  Score rate;               // Estimated against true net skin rate
+  double crossRawS;         // First time at or above OVERHEAT_TEMP_C (-1: never)
+  double crossEmaS;
+  double crossEstS;
+  double crossTrueS;
+};
+
+static uint32_t seed = SEED;
+
+// Box-Muller over a 32-bit LCG (deterministic across runs)
+static double gaussian() {
+  seed = seed * 1664525UL + 1013904223UL;
+  double u1 = ((seed >> 8) + 1.0) / 16777217.0;
+  seed = seed * 1664525UL + 1013904223UL;
+  double u2 = (seed >> 8) / 16777216.0;
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int16_t reading(double celsius) {
+  double noisy = celsius + gaussian() * ESTIMATOR_SENSOR_NOISE_C;
+  return (int16_t)lround(noisy * 100.0);
+}
+
+static void add(Score* score, double error) {
+  score->sumSq += error * error;
+  score->sum += error;
+  score->count++;
+}
+
+static double rms(const Score& score) {
+  return score.count ? sqrt(score.sumSq / score.count) : 0.0;
+}
+
+static double mean(const Score& score) {
+  return score.count ? score.sum / score.count : 0.0;
+}
+
+static void crossing(double* at, double value, double t) {
+  if (*at < 0.0 && value >= OVERHEAT_TEMP_C / 100.0) {
+    *at = t;
+  }
+}
+
+// Same tracking index as estimator.cpp, in double
+static double alphaFor(double stepS) {
+  double lambda = ESTIMATOR_ACCEL_NOISE_C * stepS * stepS / ESTIMATOR_SENSOR_NOISE_C;
+  double r = (4.0 + lambda - sqrt(8.0 * lambda + lambda * lambda)) / 4.0;
+  return 1.0 - r * r;
+}
+
+static Result run(const Scenario& sc, uint16_t periodMs) {
+  Result res;
+  memset(&res, 0, sizeof(res));
+  res.crossRawS = res.crossEmaS = res.crossEstS = res.crossTrueS = -1.0;
+
+  double periodS = periodMs / 1000.0;
+  double alpha = alphaFor(periodS);
+  double skin = sc.skin;
+  double water = sc.water;
+  double ema = skin;
+  estimatorInit(reading(skin), reading(water));
+
+  int subSteps = (int)lround(periodS / SIM_STEP_S);
+  for (double t = 0.0; t < sc.durationS; t += periodS) {
+    uint8_t speed = (sc.pumpOnS >= 0.0 && t >= sc.pumpOnS) ? PUMP_MAX_SPEED : 0;
+
+    // Truth over the step, with the model the estimator assumes
+    double netRate = 0.0;
+    for (int i = 0; i < subSteps; i++) {
+      netRate = sc.skinHeat - ESTIMATOR_COOLING_PER_S * (skin - water) * speed / 255.0;
+      skin += netRate * SIM_STEP_S;
+      crossing(&res.crossTrueS, skin, t + (i + 1) * SIM_STEP_S);
+    }
+
+    int16_t skinRaw = reading(skin);
+    ema += alpha * (skinRaw / 100.0 - ema);
+    estimatorUpdate(skinRaw, reading(water), speed, periodMs);
+    const ThermalEstimate& est = estimatorGet();
+
+    double now = t + periodS;
+    crossing(&res.crossRawS, skinRaw / 100.0, now);
+    crossing(&res.crossEmaS, ema, now);
+    crossing(&res.crossEstS, est.skinTemp / 100.0, now);
+
+    if (now >= SETTLE_S) {
+      add(&res.raw, skinRaw / 100.0 - skin);
+      add(&res.ema, ema - skin);
+      add(&res.est, est.skinTemp / 100.0 - skin);
+      add(&res.rate, est.skinRate / 1000.0 - netRate);
+    }
+  }
+  return res;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+static const Scenario scenarios[] = {
+  // name        duration  skin  water  heat               pump on
+  { "STEADY",    600.0,    35.0, 10.0,  0.0,               -1.0  },
+  { "RAMP",      600.0,    33.0, 10.0,  RAMP_C_PER_S,      -1.0  },
+  { "PUMP",      600.0,    37.0, 5.0,   BODY_HEAT_C_PER_S, 120.0 },
+  { "OVERHEAT",  600.0,    38.0, 10.0,  BODY_HEAT_C_PER_S / 2, -1.0 }
+};
+
+#define SCENARIO_COUNT  (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const uint16_t periods[] = { ESTIMATOR_PERIOD_MS, TEMP_RATE_ACTIVE_MS, TEMP_READ_INTERVAL_MS };
+
+#define PERIOD_COUNT  (sizeof(periods) / sizeof(periods[0]))
+
+int main() {
+  unsigned failures = 0;
+
+  printf("Reading noise %.3f C (1 sigma), accel noise %.3f C/s^2; errors in C, rates in C/s\n",
+         (double)ESTIMATOR_SENSOR_NOISE_C, (double)ESTIMATOR_ACCEL_NOISE_C);
+
+  for (uint8_t p = 0; p < PERIOD_COUNT; p++) {
+    uint16_t periodMs = periods[p];
+    printf("\nStep %u ms (alpha %.3f)\n", periodMs, alphaFor(periodMs / 1000.0));
+    printf("  %-9s %9s %9s %9s %9s %9s %9s\n",
+           "", "raw RMS", "EMA RMS", "est RMS", "EMA mean", "est mean", "rate RMS");
+
+    for (uint8_t s = 0; s < SCENARIO_COUNT; s++) {
+      const Scenario& sc = scenarios[s];
+      seed = SEED;
+      Result r = run(sc, periodMs);
+
+      printf("  %-9s %9.4f %9.4f %9.4f %+9.4f %+9.4f %9.5f\n",
+             sc.name, rms(r.raw), rms(r.ema), rms(r.est), mean(r.ema), mean(r.est), rms(r.rate));
+
+      if (sc.skinHeat == RAMP_C_PER_S) {
+        double emaLag = -mean(r.ema) / RAMP_C_PER_S;
+        double estLag = -mean(r.est) / RAMP_C_PER_S;
+        printf("  %-9s lag: EMA %.2f s, estimate %.2f s\n", "", emaLag, estLag);
+        if (fabs(estLag) >= fabs(emaLag)) {
+          printf("  FAIL: estimate lags the ramp as much as the EMA\n");
+          failures++;
+        }
+      }
+      if (r.crossTrueS >= 0.0) {
+        printf("  %-9s 40.00 C reached at %.1f s: raw %+.1f s, EMA %+.1f s, estimate %+.1f s\n", "",
+               r.crossTrueS, r.crossRawS - r.crossTrueS, r.crossEmaS - r.crossTrueS,
+               r.crossEstS - r.crossTrueS);
+      }
+      if (rms(r.est) >= rms(r.raw)) {
+        printf("  FAIL: estimate noisier than the raw readings\n");
+        failures++;
+      }
+    }
+  }
+
+  if (failures != 0) {
+    printf("\nFAIL: %u failures\n", failures);
+    return 1;
+  }
+  printf("\nPASS\n");
+  return 0;
+}
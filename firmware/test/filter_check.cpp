@@ -0,0 +1,173 @@
+/*
+ * filter_check.cpp
+ * Host check: median exchange networks and the integer EMA of filter.cpp
+ *
+ * filter.cpp is included (not linked) so its static median() can be
+ * called directly; CHECK_MEDIAN_SIZE replaces FILTER_MEDIAN_SIZE, so the
+ * Makefile builds this check once per network.
+ *
+ * - median() against a sort: every window drawn from 4 values (duplicates
+ *   included), every permutation of distinct values, 1,000,000 random
+ *   12-bit windows
+ * - filterAdd(): spikes up to (N-1)/2 readings long leave the output
+ *   alone, and a step follows a double-precision EMA of the median
+ *   within one count
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include <algorithm>
+#include "config.h"
+
+#ifdef CHECK_MEDIAN_SIZE
+  #undef FILTER_MEDIAN_SIZE
+  #define FILTER_MEDIAN_SIZE  CHECK_MEDIAN_SIZE
+#endif
+
+#include "filter.cpp"
+
+#define RANDOM_WINDOWS  1000000UL
+#define LEVEL           2000
+#define SPIKE           4092
+#define STEP_LOW        1000
+#define STEP_HIGH       3000
+#define STEP_READINGS   200
+
+static unsigned failures = 0;
+
+static void fail(const char* what, const uint16_t* window) {
+  if (failures++ < 10) {
+    printf("FAIL: %s, window", what);
+    for (uint8_t i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+      printf(" %u", window[i]);
+    }
+    printf("\n");
+  }
+}
+
+// ============================================================================
+// MEDIAN NETWORK
+// ============================================================================
+
+static uint16_t sortedMedian(const uint16_t* window) {
+  uint16_t sorted[FILTER_MEDIAN_SIZE];
+  std::copy(window, window + FILTER_MEDIAN_SIZE, sorted);
+  std::sort(sorted, sorted + FILTER_MEDIAN_SIZE);
+  return sorted[FILTER_MEDIAN_SIZE / 2];
+}
+
+static unsigned long checkWindow(const uint16_t* window) {
+  if (median(window) != sortedMedian(window)) {
+    fail("median differs from sort", window);
+  }
+  return 1;
+}
+
+static unsigned long checkMedian() {
+  uint16_t window[FILTER_MEDIAN_SIZE];
+  unsigned long windows = 0;
+
+  // Every window over 4 values: covers every order and tie pattern
+  unsigned long combinations = 1UL << (2 * FILTER_MEDIAN_SIZE);
+  for (unsigned long n = 0; n < combinations; n++) {
+    for (uint8_t i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+      window[i] = (uint16_t)(((n >> (2 * i)) & 3) * 1000);
+    }
+    windows += checkWindow(window);
+  }
+
+  // Every permutation of distinct values
+  for (uint8_t i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+    window[i] = (uint16_t)(i * 7 + 3);
+  }
+  do {
+    windows += checkWindow(window);
+  } while (std::next_permutation(window, window + FILTER_MEDIAN_SIZE));
+
+  // Random oversampled readings
+  uint32_t seed = 12345;
+  for (unsigned long n = 0; n < RANDOM_WINDOWS; n++) {
+    for (uint8_t i = 0; i < FILTER_MEDIAN_SIZE; i++) {
+      seed = seed * 1103515245UL + 12345UL;
+      window[i] = (uint16_t)((seed >> 8) & 0x0FFF);
+    }
+    windows += checkWindow(window);
+  }
+
+  return windows;
+}
+
+// ============================================================================
+// FILTER
+// ============================================================================
+
+// Spikes shorter than half the window never reach the average
+static void checkSpikes() {
+  for (uint8_t length = 1; length <= (FILTER_MEDIAN_SIZE - 1) / 2; length++) {
+    SampleFilter filter;
+    filterReset(&filter, LEVEL);
+    for (uint8_t i = 0; i < 4 * FILTER_MEDIAN_SIZE; i++) {
+      bool spike = (i % FILTER_MEDIAN_SIZE) < length;
+      uint16_t out = filterAdd(&filter, spike ? SPIKE : LEVEL);
+      if (out != LEVEL) {
+        uint16_t reading = spike ? SPIKE : LEVEL;
+        fail("spike reached the output", &reading);
+        break;
+      }
+    }
+  }
+}
+
+// A step follows an exact EMA of the (delayed) median
+static double checkStep() {
+  SampleFilter filter;
+  filterReset(&filter, STEP_LOW);
+
+  uint16_t window[FILTER_MEDIAN_SIZE];
+  std::fill(window, window + FILTER_MEDIAN_SIZE, (uint16_t)STEP_LOW);
+  double ema = STEP_LOW;
+  double worst = 0.0;
+
+  for (uint16_t n = 0; n < STEP_READINGS; n++) {
+    window[n % FILTER_MEDIAN_SIZE] = STEP_HIGH;
+    ema += (sortedMedian(window) - ema) / (double)(1UL << FILTER_EMA_SHIFT);
+
+    uint16_t out = filterAdd(&filter, STEP_HIGH);
+    double error = fabs(out - ema);
+    if (error > worst) {
+      worst = error;
+    }
+    if (error > 1.0) {
+      fail("step differs from the EMA", &out);
+    }
+  }
+
+  if (filterGetValue(&filter) != STEP_HIGH) {
+    fail("step did not settle", window);
+  }
+  return worst;
+}
+
+// ============================================================================
+// CHECK
+// ============================================================================
+
+int main() {
+  unsigned long windows = checkMedian();
+  checkSpikes();
+  double stepError = checkStep();
+
+  printf("Median of %u: %lu windows match a sort\n", FILTER_MEDIAN_SIZE, windows);
+  printf("Spikes up to %u readings rejected\n", (FILTER_MEDIAN_SIZE - 1) / 2);
+  printf("Step %u -> %u: max %.3f counts from a double EMA (shift %u)\n",
+         STEP_LOW, STEP_HIGH, stepError, FILTER_EMA_SHIFT);
+
+  if (failures != 0) {
+    printf("FAIL: %u failures\n", failures);
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Arduino.h (host)
+ * Just enough of the Arduino core to compile firmware modules with the
+ * host compiler for the checks in firmware/test
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+
+#define F_CPU  16000000UL
+
+#define A0  14
+#define A1  15
+#define A2  16
+#define A3  17
+#define A6  20
+#define A7  21
+
+class __FlashStringHelper;
+#define F(s)  (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+
+#define constrain(x, low, high)  ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+
+// The core's min()/max() macros would break <algorithm> in the checks
+using std::min;
+using std::max;
+
+// Output base of the UART driver; the checks never print through it
+class Print {
+ public:
+  virtual size_t write(uint8_t byte) = 0;
+  virtual ~Print() {}
+};
+
+// Simulated clock, advanced by the check (host.cpp)
+unsigned long millis();
+unsigned long micros();
+void hostAdvanceUs(unsigned long us);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,11 @@
+/*
+ * avr/io.h (host)
+ * No registers: the checks only compile modules that do not touch them
+ */
+
+#ifndef HOST_IO_H
+#define HOST_IO_H
+
+#define _BV(bit)  (1U << (bit))
+
+#endif // HOST_IO_H
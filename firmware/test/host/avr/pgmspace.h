@@ -0,0 +1,31 @@
+/*
+ * avr/pgmspace.h (host)
+ * Flash and RAM are one address space on the host
+ */
+
+#ifndef HOST_PGMSPACE_H
+#define HOST_PGMSPACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P              const char*
+#define PSTR(s)            (s)
+
+#define strcmp_P           strcmp
+#define strncmp_P          strncmp
+#define strcpy_P           strcpy
+#define strncpy_P          strncpy
+#define strcat_P           strcat
+#define strlen_P           strlen
+#define memcpy_P           memcpy
+#define snprintf_P         snprintf
+
+#define pgm_read_byte(p)   (*(const uint8_t*)(p))
+#define pgm_read_word(p)   (*(const uint16_t*)(p))
+#define pgm_read_dword(p)  (*(const uint32_t*)(p))
+#define pgm_read_ptr(p)    (*(void* const*)(p))
+
+#endif // HOST_PGMSPACE_H
@@ -0,0 +1,30 @@
+/*
+ * host.cpp
+ * Simulated clock and profiler sink for the host checks
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include <Arduino.h>
+#include "perf.h"
+
+static unsigned long nowUs = 0;
+
+unsigned long millis() {
+  return nowUs / 1000UL;
+}
+
+unsigned long micros() {
+  return nowUs;
+}
+
+void hostAdvanceUs(unsigned long us) {
+  nowUs += us;
+}
+
+#if PERF_ENABLED
+void perfRecord(uint8_t stage, unsigned long durationUs) {
+  (void)stage;
+  (void)durationUs;
+}
+#endif
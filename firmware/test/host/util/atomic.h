@@ -0,0 +1,12 @@
+/*
+ * util/atomic.h (host)
+ * The checks are single-threaded; an atomic block runs once
+ */
+
+#ifndef HOST_ATOMIC_H
+#define HOST_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type)  for (int atomicOnce = 1; atomicOnce; atomicOnce = 0)
+
+#endif // HOST_ATOMIC_H
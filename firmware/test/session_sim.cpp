@@ -0,0 +1,257 @@
+/*
+ * session_sim.cpp
+ * Host simulation: 30-minute session with and without the water feedforward
+ *
+ * Runs the firmware's control step (estimator.cpp, feedforward.cpp,
+ * thermostat.cpp) every ESTIMATOR_PERIOD_MS against a simple plant, in
+ * the order taskSpeedPot() calls them, and compares duty, pump energy and
+ * time in the target band for MANUAL and AUTO, each with FF off and on.
+ * The feedforward only scales MANUAL; the AUTO rows check that switching
+ * it on leaves AUTO alone.
+ *
+ * Plant (not measured on hardware):
+ * - Skin warms towards BODY_C with time constant SKIN_TAU_S and is cooled
+ *   by COOLING_PER_S * duty/255 * (skin - water), TRANSPORT_S after the
+ *   pump duty changes (tubing delay)
+ * - The reservoir starts at WATER_START_C and warms by WATER_GAIN times
+ *   the heat taken from the skin
+ * - MANUAL_SPEED holds the middle of the band with water at
+ *   FEEDFORWARD_REF_WATER_C; COOLING_PER_S is derived from that
+ * - Readings carry 0.05°C Gaussian noise; energy is in full-duty seconds,
+ *   with pump power taken as proportional to duty squared
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "pump.h"
+#include "estimator.h"
+#include "feedforward.h"
+#include "thermostat.h"
+#include "autotune.h"
+#include "eco.h"
+#include "bluetooth.h"
+
+#define SESSION_S        1800.0
+#define BODY_C           37.0
+#define SKIN_TAU_S       120.0
+#define TRANSPORT_S      10.0
+#define WATER_START_C    2.0
+#define WATER_GAIN       0.5
+#define MANUAL_SPEED     136
+#define NOISE_C          0.05
+#define SEED             20261016UL
+#define REPORT_EVERY_S   300
+
+#define STEP_S           (ESTIMATOR_PERIOD_MS / 1000.0)
+#define DELAY_STEPS      ((int)(TRANSPORT_S / STEP_S + 0.5))
+#define REPORT_COUNT     ((int)(SESSION_S / REPORT_EVERY_S))
+
+static const double TARGET_C = (TARGET_TEMP_MIN_C + TARGET_TEMP_MAX_C) / 200.0;
+
+// Cooling per second at full duty per degree of skin-water difference:
+// MANUAL_SPEED balances the body heat at the target with the reference water
+static const double COOLING_PER_S = (BODY_C - TARGET_C) / SKIN_TAU_S /
+                                    (MANUAL_SPEED / 255.0 * (TARGET_C - FEEDFORWARD_REF_WATER_C));
+
+// ============================================================================
+// FIRMWARE STUBS (pump driver, modes the session does not use)
+// ============================================================================
+
+static uint16_t commandedLevel = 0;
+
+PumpState pumpGetState() {
+  return (commandedLevel > 0 || thermostatGetMode() == THERMOSTAT_AUTO) ? PUMP_ON : PUMP_OFF;
+}
+
+uint8_t pumpGetSpeed() {
+  return HIRES_TO_SPEED(commandedLevel);
+}
+
+uint16_t pumpGetSpeedHiRes() {
+  return commandedLevel;
+}
+
+bool pumpSetSpeedHiRes(uint16_t level) {
+  commandedLevel = level;
+  return true;
+}
+
+void autotuneCancel() {
+}
+
+void autotuneStep(const ThermalEstimate& estimate) {
+  (void)estimate;
+}
+
+void ecoReset() {
+}
+
+void ecoStep(const ThermalEstimate& estimate) {
+  (void)estimate;
+}
+
+char* bluetoothFormatTemperature(int16_t temperature, char* buffer, size_t bufferSize) {
+  snprintf(buffer, bufferSize, "%.1f", temperature / 100.0);
+  return buffer;
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+struct Session {
+  const char* name;
+  ThermostatMode mode;
+  bool feedforward;
+};
+
+struct Totals {
+  double dutySum;
+  double energy;            // Full-duty seconds, power ~ duty^2
+  unsigned long steps;
+  unsigned long inBand;
+  unsigned long below;
+  unsigned long above;
+  double waterEnd;
+  int dutyAt[REPORT_COUNT];
+};
+
+static uint32_t seed = SEED;
+
+static double gaussian() {
+  seed = seed * 1664525UL + 1013904223UL;
+  double u1 = ((seed >> 8) + 1.0) / 16777217.0;
+  seed = seed * 1664525UL + 1013904223UL;
+  double u2 = (seed >> 8) / 16777216.0;
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int16_t reading(double celsius) {
+  return (int16_t)lround((celsius + gaussian() * NOISE_C) * 100.0);
+}
+
+static Totals run(const Session& session) {
+  Totals totals;
+  memset(&totals, 0, sizeof(totals));
+  seed = SEED;
+
+  double skin = TARGET_C;
+  double water = WATER_START_C;
+  double delayed[DELAY_STEPS];
+  for (int i = 0; i < DELAY_STEPS; i++) {
+    delayed[i] = 0.0;
+  }
+
+  estimatorInit(reading(skin), reading(water));
+  feedforwardInit();
+  feedforwardSetEnabled(session.feedforward);
+  thermostatInit();
+  thermostatResetGains();
+  commandedLevel = SPEED_TO_HIRES(MANUAL_SPEED);
+  thermostatSetMode(session.mode);
+
+  unsigned long steps = (unsigned long)(SESSION_S / STEP_S + 0.5);
+  for (unsigned long n = 0; n < steps; n++) {
+    // Control step, as in taskSpeedPot()
+    uint8_t pumpSpeed = HIRES_TO_SPEED(feedforwardApply(pumpGetSpeedHiRes()));
+    estimatorUpdate(reading(skin), reading(water), pumpSpeed, ESTIMATOR_PERIOD_MS);
+    feedforwardUpdate(estimatorGet());
+    thermostatUpdate(estimatorGet());
+    double duty = HIRES_TO_SPEED(feedforwardApply(commandedLevel));
+
+    // Plant over the step, cooling from the duty TRANSPORT_S ago
+    double flowing = delayed[n % DELAY_STEPS];
+    delayed[n % DELAY_STEPS] = duty;
+    double removed = COOLING_PER_S * flowing / 255.0 * (skin - water) * STEP_S;
+    skin += (BODY_C - skin) / SKIN_TAU_S * STEP_S - removed;
+    water += WATER_GAIN * removed;
+    hostAdvanceUs(ESTIMATOR_PERIOD_MS * 1000UL);
+
+    totals.dutySum += duty;
+    totals.energy += (duty / 255.0) * (duty / 255.0) * STEP_S;
+    totals.steps++;
+    if (skin < TARGET_TEMP_MIN_C / 100.0) {
+      totals.below++;
+    } else if (skin > TARGET_TEMP_MAX_C / 100.0) {
+      totals.above++;
+    } else {
+      totals.inBand++;
+    }
+    if (n % (unsigned long)(REPORT_EVERY_S / STEP_S + 0.5) == 0) {
+      totals.dutyAt[n / (unsigned long)(REPORT_EVERY_S / STEP_S + 0.5)] = (int)duty;
+    }
+  }
+
+  totals.waterEnd = water;
+  return totals;
+}
+
+static double percent(unsigned long part, unsigned long whole) {
+  return whole ? 100.0 * part / whole : 0.0;
+}
+
+// ============================================================================
+// SESSIONS
+// ============================================================================
+
+static const Session sessions[] = {
+  { "MANUAL 136",      THERMOSTAT_MANUAL, false },
+  { "MANUAL 136 + FF", THERMOSTAT_MANUAL, true  },
+  { "AUTO",            THERMOSTAT_AUTO,   false },
+  { "AUTO + FF",       THERMOSTAT_AUTO,   true  }
+};
+
+#define SESSION_COUNT  (sizeof(sessions) / sizeof(sessions[0]))
+
+int main() {
+  Totals totals[SESSION_COUNT];
+  for (uint8_t s = 0; s < SESSION_COUNT; s++) {
+    totals[s] = run(sessions[s]);
+  }
+
+  printf("30-minute session: skin starts at %.2f C, water at %.1f C; band %.2f-%.2f C\n",
+         TARGET_C, WATER_START_C, TARGET_TEMP_MIN_C / 100.0, TARGET_TEMP_MAX_C / 100.0);
+
+  printf("\n  duty vs time (min) ");
+  for (int i = 0; i < REPORT_COUNT; i++) {
+    printf("%5d", i * REPORT_EVERY_S / 60);
+  }
+  printf("\n");
+  for (uint8_t s = 0; s < SESSION_COUNT; s++) {
+    printf("  %-18s ", sessions[s].name);
+    for (int i = 0; i < REPORT_COUNT; i++) {
+      printf("%5d", totals[s].dutyAt[i]);
+    }
+    printf("\n");
+  }
+
+  printf("\n  %-18s %9s %8s %8s %8s %8s %8s\n",
+         "", "mean duty", "energy", "in band", "below", "above", "water");
+  for (uint8_t s = 0; s < SESSION_COUNT; s++) {
+    const Totals& t = totals[s];
+    printf("  %-18s %9.1f %8.1f %7.0f%% %7.0f%% %7.0f%% %6.1f C\n",
+           sessions[s].name, t.dutySum / t.steps, t.energy,
+           percent(t.inBand, t.steps), percent(t.below, t.steps), percent(t.above, t.steps),
+           t.waterEnd);
+  }
+
+  double manualSaved = 100.0 * (1.0 - totals[1].energy / totals[0].energy);
+  double autoSaved = 100.0 * (1.0 - totals[3].energy / totals[2].energy);
+  printf("\n  Energy saved by FF: MANUAL %.0f%%, AUTO %.0f%%\n", manualSaved, autoSaved);
+
+  // The feedforward must save energy in MANUAL without losing time in the
+  // band, and must not cost energy in AUTO
+  if (manualSaved <= 0.0 || totals[1].inBand < totals[0].inBand) {
+    printf("FAIL: feedforward does not improve the MANUAL session\n");
+    return 1;
+  }
+  if (autoSaved < 0.0) {
+    printf("FAIL: feedforward costs energy in AUTO\n");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * thermistor_check.cpp
+ * Host check: compile-time thermistor table against the float reference
+ *
+ * Builds thermistor.cpp with the host compiler and compares every ADC code
+ * (and the oversampled codes in the wearable range) with the B equation,
+ * or the THERMISTOR_RT_TABLE curve, evaluated in double with libm log().
+ * Fails if any code is off by more than MAX_ERROR_C.
+ *
+ * Codes 1022 and 1023 read above 327°C and saturate; they are skipped.
+ *
+ * Team: BME 200/300 Section 301
+ */
+
+#include <Arduino.h>
+#include <math.h>
+#include "config.h"
+#include "thermistor.h"
+
+#define MAX_ERROR_C        0.05
+#define KELVIN_OFFSET      273.15
+#define OVERSAMPLE_BITS    2
+#define WEAR_MIN_C         (-10.0)   // Oversampled codes are checked in this range
+#define WEAR_MAX_C         60.0
+
+// ============================================================================
+// FLOAT REFERENCE
+// ============================================================================
+
+#ifdef THERMISTOR_RT_TABLE
+
+struct RtPoint {
+  double celsius;
+  double ohms;
+};
+
+static const RtPoint rtTable[] = THERMISTOR_RT_TABLE;
+static const int RT_COUNT = sizeof(rtTable) / sizeof(rtTable[0]);
+
+// Linear in ln(R) vs 1/T between points, the end segments extrapolated
+static double ohmsToCelsius(double ohms) {
+  int i = 0;
+  while (i < RT_COUNT - 2 && ohms <= rtTable[i + 1].ohms) {
+    i++;
+  }
+  double t0 = 1.0 / (rtTable[i].celsius + KELVIN_OFFSET);
+  double t1 = 1.0 / (rtTable[i + 1].celsius + KELVIN_OFFSET);
+  double f = (log(ohms) - log(rtTable[i].ohms)) / (log(rtTable[i + 1].ohms) - log(rtTable[i].ohms));
+  return 1.0 / (t0 + (t1 - t0) * f) - KELVIN_OFFSET;
+}
+
+#else
+
+// The runtime conversion the table replaced
+static double ohmsToCelsius(double ohms) {
+  double steinhart = log(ohms / THERMISTOR_NOMINAL) / B_COEFFICIENT;
+  steinhart += 1.0 / (TEMPERATURE_NOMINAL + KELVIN_OFFSET);
+  return 1.0 / steinhart - KELVIN_OFFSET;
+}
+
+#endif // THERMISTOR_RT_TABLE
+
+static double referenceCelsius(double adc) {
+  return ohmsToCelsius(SERIES_RESISTOR * (1023.0 / adc - 1.0));
+}
+
+// ============================================================================
+// CHECK
+// ============================================================================
+
+int main() {
+  double worst = 0.0;
+  double worstAdc = 0.0;
+  double lowC = 1e9;
+  double highC = -1e9;
+  unsigned checked = 0;
+
+  // Every 10-bit code
+  for (uint16_t code = 1; code <= 1021; code++) {
+    double reference = referenceCelsius(code);
+    double error = fabs(thermistorToCentiCelsius(code) / 100.0 - reference);
+    if (error > worst) {
+      worst = error;
+      worstAdc = code;
+    }
+    if (reference < lowC) lowC = reference;
+    if (reference > highC) highC = reference;
+    checked++;
+  }
+
+  double worstCode = worst;
+
+  // Oversampled readings interpolate between codes
+  unsigned steps = 1U << OVERSAMPLE_BITS;
+  double worstOversampled = 0.0;
+  for (uint16_t code = 1; code < 1021; code++) {
+    for (uint16_t fraction = 1; fraction < steps; fraction++) {
+      double adc = code + (double)fraction / steps;
+      double reference = referenceCelsius(adc);
+      if (reference < WEAR_MIN_C || reference > WEAR_MAX_C) {
+        continue;
+      }
+      uint16_t scaled = (uint16_t)((code << OVERSAMPLE_BITS) | fraction);
+      double error = fabs(thermistorToCentiCelsius(scaled, OVERSAMPLE_BITS) / 100.0 - reference);
+      if (error > worstOversampled) {
+        worstOversampled = error;
+      }
+      if (error > worst) {
+        worst = error;
+        worstAdc = adc;
+      }
+      checked++;
+    }
+  }
+
+  #ifdef THERMISTOR_RT_TABLE
+    printf("Reference: THERMISTOR_RT_TABLE (%d points)\n", RT_COUNT);
+  #else
+    printf("Reference: B equation, B=%.0f, R0=%.0f, Rs=%.0f\n",
+           (double)B_COEFFICIENT, (double)THERMISTOR_NOMINAL, (double)SERIES_RESISTOR);
+  #endif
+  printf("Codes 1-1021: %.1f to %.1f C\n", lowC, highC);
+  printf("Max error: codes %.4f C, oversampled %.4f C (%.0f to %.0f C)\n",
+         worstCode, worstOversampled, WEAR_MIN_C, WEAR_MAX_C);
+  printf("Checked %u readings, worst at ADC %.2f\n", checked, worstAdc);
+
+  if (worst > MAX_ERROR_C) {
+    printf("FAIL: above %.2f C\n", MAX_ERROR_C);
+    return 1;
+  }
+  printf("PASS (limit %.2f C)\n", MAX_ERROR_C);
+  return 0;
+}
@@ -3,6 +3,11 @@
  *
  * This sketch helps diagnose and calibrate NTC thermistors
  * Connect thermistors to A0 and A1 with 10kΩ pull-up resistors
+ *
+ * The Testicool firmware no longer needs this sketch and a recompile for
+ * calibration: its CAL commands solve and store the offset and B of each
+ * probe over Bluetooth (see Testicool/README.md). Use this one to check
+ * the wiring.
  */
 
 #define WATER_PIN A0